@@ -0,0 +1,138 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+
+// Описание записи на этапе компиляции: список полей (указатель на член и
+// ширина колонки). По нему генерируются упакованная сериализация (поля
+// подряд, без выравнивания, в порядке описания), вывод колонками, как у
+// cout << std::left << std::setw(ширина), и доступ к полям по номеру.
+// Всё раскрывается в прямые memcpy/to_chars без циклов по описанию.
+// Поддерживаются целые, числа с плавающей точкой и char[N] (строка до '\0').
+
+// Кодирование значения одного типа; общий случай - целые и double.
+template <class T>
+struct FieldCodec {
+   static_assert(std::is_arithmetic_v<T>, "unsupported field type");
+   static constexpr size_t packedSize = sizeof(T);
+   static constexpr size_t maxFormattedSize = 32;
+
+   static char* pack(const T& value, char* p) {
+      std::memcpy(p, &value, sizeof(T));
+      return p + sizeof(T);
+   }
+
+   static const char* unpack(T& value, const char* p) {
+      std::memcpy(&value, p, sizeof(T));
+      return p + sizeof(T);
+   }
+
+   // Как cout по умолчанию: для чисел с плавающей точкой - %g с 6 знаками.
+   static char* format(const T& value, char* p) {
+      if constexpr (std::is_floating_point_v<T>) {
+         return std::to_chars(p, p + maxFormattedSize, value, std::chars_format::general, 6).ptr;
+      }
+      else {
+         return std::to_chars(p, p + maxFormattedSize, value).ptr;
+      }
+   }
+};
+
+// Строка фиксированного размера: при упаковке байты после '\0' обнуляются,
+// чтобы мусор из памяти не попадал в файл.
+template <size_t N>
+struct FieldCodec<char[N]> {
+   static constexpr size_t packedSize = N;
+   static constexpr size_t maxFormattedSize = N;
+
+   static size_t length(const char (&value)[N]) {
+      const void* terminator = std::memchr(value, '\0', N);
+      return terminator ? static_cast<const char*>(terminator) - value : N;
+   }
+
+   static char* pack(const char (&value)[N], char* p) {
+      size_t used = length(value);
+      std::memcpy(p, value, used);
+      std::memset(p + used, 0, N - used);
+      return p + N;
+   }
+
+   static const char* unpack(char (&value)[N], const char* p) {
+      std::memcpy(value, p, N);
+      return p + N;
+   }
+
+   static char* format(const char (&value)[N], char* p) {
+      size_t used = length(value);
+      std::memcpy(p, value, used);
+      return p + used;
+   }
+};
+
+template <auto Member, size_t Width = 0>
+struct Field;
+
+template <class Record, class T, T Record::*Member, size_t Width>
+struct Field<Member, Width> {
+   using Codec = FieldCodec<T>;
+   using RecordType = Record;
+   using ValueType = T;
+   static constexpr size_t width = Width;
+   static constexpr size_t packedSize = Codec::packedSize;
+   static constexpr size_t maxFormattedSize = std::max(Width, Codec::maxFormattedSize);
+
+   static T& get(Record& record) { return record.*Member; }
+   static const T& get(const Record& record) { return record.*Member; }
+
+   static char* pack(const Record& record, char* p) { return Codec::pack(record.*Member, p); }
+   static const char* unpack(Record& record, const char* p) { return Codec::unpack(record.*Member, p); }
+
+   // Значение, дополненное пробелами справа до ширины колонки.
+   static char* format(const Record& record, char* p) {
+      char* end = Codec::format(record.*Member, p);
+      if (static_cast<size_t>(end - p) < Width) {
+         std::memset(end, ' ', Width - (end - p));
+         return p + Width;
+      }
+      return end;
+   }
+};
+
+template <class Record, class... Fields>
+struct RecordSchema {
+   static_assert((std::is_same_v<Record, typename Fields::RecordType> && ...), "field of another record");
+
+   static constexpr size_t fieldCount = sizeof...(Fields);
+   static constexpr size_t packedSize = (Fields::packedSize + ... + 0);
+   // Буфер под одну строку format() (без перевода строки).
+   static constexpr size_t maxFormattedSize = (Fields::maxFormattedSize + ... + 0);
+
+   template <size_t I>
+   using FieldAt = std::tuple_element_t<I, std::tuple<Fields...>>;
+
+   template <size_t I>
+   static auto& get(Record& record) { return FieldAt<I>::get(record); }
+   template <size_t I>
+   static const auto& get(const Record& record) { return FieldAt<I>::get(record); }
+
+   // Writes packedSize bytes at p and returns the position after them.
+   static char* pack(const Record& record, char* p) {
+      ((p = Fields::pack(record, p)), ...);
+      return p;
+   }
+
+   static const char* unpack(Record& record, const char* p) {
+      ((p = Fields::unpack(record, p)), ...);
+      return p;
+   }
+
+   // Writes at most maxFormattedSize bytes at p.
+   static char* format(const Record& record, char* p) {
+      ((p = Fields::format(record, p)), ...);
+      return p;
+   }
+};
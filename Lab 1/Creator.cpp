@@ -1,7 +1,5 @@
-﻿#include <fstream>
-#include <string>
-#include <iostream>
-#include "employee.h"
+﻿#include <iostream>
+#include "employee_io.h"
 
 int main(int argc, char* argv[]) {
 
@@ -9,26 +7,14 @@ int main(int argc, char* argv[]) {
 	std::cin.tie(0);
 	std::cout.tie(0);
 
-	std::string filename = argv[1];
-	int count = std::stoi(argv[2]);
-
-	std::ofstream out(filename, std::ios::binary);
-
-	for (int i = 0; i < count; i++) {
-		employee person;
-
-		std::cout << "Person #: " << i + 1 << "\nEnter the employee's identification number:\n";
-		std::cin >> person.num;
-
-		std::cout << "Enter the employee's name (maximum 9 letters):\n";
-		std::cin >> person.name;
-
-		std::cout << "Enter the number of working hours:\n";
-		std::cin >> person.hours;
-
-		out.write(reinterpret_cast<char*>(&person), sizeof(employee));
+	CreatorOptions options;
+	if (!parseCreatorArguments(argc, argv, options)) {
+		std::cout << "Usage: Creator <binary file> <count> [--synthetic SEED | --csv] [--columnar | --archive] [--index] [--checksum]\n"
+			"       [--threads N]\n"
+			"--checksum writes CRC-32C sums of record blocks to <binary file>.crc (legacy format only).\n"
+			"--threads N generates a --synthetic file with N threads; the file does not depend on N.\n";
+		return 1;
 	}
 
-	out.close();
-	return 0;
+	return createEmployees(options);
 }
\ No newline at end of file
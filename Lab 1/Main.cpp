@@ -2,102 +2,219 @@
 #include <string>
 #include <iomanip>
 #include <fstream>
-#include <windows.h>
 #include <vector>
+#include <cstring>
 #include "employee.h"
+#include "employee_file.h"
+#include "process.h"
+#include "employee_io.h"
+#include "console_dump.h"
 
 using std::cin;
 using std::cout;
 
+void printEmployeeRow(const employee& person) {
+	cout << std::left << std::setw(15) << person.num
+		<< std::setw(15) << person.name
+		<< std::setw(15) << person.hours
+		<< "\n";
+}
+
+// Ограничение вывода файлов (--head/--tail N).
+DumpRange dumpRange;
+
 void printBinFile(const std::string& fileName) {
 
-	std::ifstream fin(fileName, std::ios::binary);
-	if (!fin) {
+	cout.flush();
+	OutputFile console;
+	console.openStandardOutput();
+	if (!dumpBinFile(fileName, dumpRange, console)) {
 		cout << "Cannot open binary file " << fileName << "\n";
-		return;
 	}
-
-	employee person;
-	cout << "\n\tBinary file content:\n";
-	cout << std::left << std::setw(15) << "Employee ID";
-	cout << std::left << std::setw(15) << "Employee name";
-	cout << std::left << std::setw(15) << "Employee hours\n";
-	while (fin.read(reinterpret_cast<char*>(&person), sizeof(person))) {
-		cout << std::left << std::setw(15) << person.num
-			<< std::setw(15) << person.name
-			<< std::setw(15) << person.hours
-			<< "\n";
-	}
-	fin.close();
 }
 
 void printReportFile(const std::string& fileName) {
 
-	std::ifstream fin(fileName);
-	if (!fin) {
+	cout.flush();
+	OutputFile console;
+	console.openStandardOutput();
+	if (!dumpTextFile(fileName, dumpRange, console)) {
 		cout << "Cannot open report file " << fileName << "\n";
-		return;
 	}
+}
 
-	std::string line;
-	while (std::getline(fin, line)) {
-		cout << line << "\n";
+void runProcess(const std::vector<std::string>& args) {
+
+	ChildProcess child;
+	if (!startProcess(args, child)) {
+		throw std::runtime_error("Не удалось запустить процесс: " + args[0]);
 	}
-	fin.close();
+	waitProcess(child);
 }
 
-void runProcess(const std::string& cmd) {
+// По умолчанию Creator и Reporter вызываются как функции библиотеки
+// employee_io; с --spawn запускаются отдельные процессы, как раньше.
+void runSequential(bool spawn) {
 
-	PROCESS_INFORMATION pi;
-	STARTUPINFO si;
-	ZeroMemory(&si, sizeof(STARTUPINFO));
-	si.cb = sizeof(STARTUPINFO);
+	std::string binFileName;
+	std::string countText;
+	unsigned long long count;
 
-	std::wstring wcmd(cmd.begin(), cmd.end());
+	cout << "Enter the name of the binary file:\n";
+	cin >> binFileName;
+	cout << "Enter the number of entries:\n";
+	cin >> countText;
+	cout.flush();
+	// Число записей проверяется здесь: Creator как функция его уже не разбирает.
+	if (!cin || !parseNumber(countText, count)) {
+		throw std::runtime_error("Неверное число записей: " + countText);
+	}
 
-	if (!CreateProcess(
-		NULL, &wcmd[0], NULL, NULL,
-		FALSE, 0, NULL, NULL, &si, &pi
-	)) {
-		throw std::runtime_error("Не удалось запустить процесс: " + cmd);
+	if (spawn) {
+		runProcess({ executableName("Creator"), binFileName, std::to_string(count) });
+	}
+	else {
+		CreatorOptions creatorOptions;
+		creatorOptions.fileName = binFileName;
+		creatorOptions.count = count;
+		if (createEmployees(creatorOptions) != 0) {
+			throw std::runtime_error("Не удалось создать файл " + binFileName);
+		}
 	}
+	printBinFile(binFileName);
 
-	WaitForSingleObject(pi.hProcess, INFINITE);
+	std::string reportFileName;
+	double payPerHour;
 
-	CloseHandle(pi.hProcess);
-	CloseHandle(pi.hThread);
-}
+	cout << "Enter the name of the peport file:\n";
+	cin >> reportFileName;
+	cout << "Enter the payment per hour:\n";
+	cin >> payPerHour;
+	cout.flush();
 
-int main() {
+	if (spawn) {
+		runProcess({ executableName("Reporter"), binFileName, reportFileName, std::to_string(payPerHour) });
+	}
+	else {
+		ReporterOptions reporterOptions;
+		reporterOptions.binFileName = binFileName;
+		reporterOptions.reportFileName = reportFileName;
+		reporterOptions.xPerHour = payPerHour;
+		if (generateReport(reporterOptions) < 0) {
+			throw std::runtime_error("Не удалось построить отчёт " + reportFileName);
+		}
+	}
+	printReportFile(reportFileName);
+}
 
-	std::iostream::sync_with_stdio(false);
-	std::cin.tie(0);
-	std::cout.tie(0);
+// Конвейер без промежуточного файла: Creator пишет записи в канал,
+// Main показывает каждую запись по мере поступления и тут же передаёт
+// её по второму каналу в Reporter.
+void runPipeline() {
 
-	std::string binFileName;
 	int count;
+	std::string reportFileName;
+	double payPerHour;
 
-	cout << "Enter the name of the binary file:\n";
-	cin >> binFileName;
 	cout << "Enter the number of entries:\n";
 	cin >> count;
+	cout << "Enter the name of the peport file:\n";
+	cin >> reportFileName;
+	cout << "Enter the payment per hour:\n";
+	cin >> payPerHour;
+	cout.flush();
+
+	Pipe fromCreator, toReporter;
+	if (!createPipe(fromCreator) || !createPipe(toReporter)) {
+		throw std::runtime_error("Не удалось создать канал");
+	}
+#ifndef _WIN32
+	signal(SIGPIPE, SIG_IGN);
+#endif
+
+	ChildProcess creator, reporter;
+	if (!startProcess({ executableName("Creator"), "-", std::to_string(count) },
+		creator, NO_HANDLE, fromCreator.writeEnd)) {
+		throw std::runtime_error("Не удалось запустить процесс: Creator");
+	}
+	closeHandle(fromCreator.writeEnd);
 
-	try {
-		std::string creatorToCmd = "Creator.exe " + binFileName + " " + std::to_string(count);
-		runProcess(creatorToCmd);
-		printBinFile(binFileName);
+	if (!startProcess({ executableName("Reporter"), "-", reportFileName, std::to_string(payPerHour),
+		"--label", "pipeline" }, reporter, toReporter.readEnd)) {
+		throw std::runtime_error("Не удалось запустить процесс: Reporter");
+	}
+	closeHandle(toReporter.readEnd);
+
+	cout << "\n\tBinary records:\n";
+	cout << std::left << std::setw(15) << "Employee ID";
+	cout << std::left << std::setw(15) << "Employee name";
+	cout << std::left << std::setw(15) << "Employee hours\n";
+	cout.flush();
+
+	std::vector<char> buffer(1 << 16);
+	size_t filled = 0;
+	bool reporterAlive = true;
+	long long got;
+	while ((got = readSome(fromCreator.readEnd, buffer.data() + filled, buffer.size() - filled)) > 0) {
+		filled += static_cast<size_t>(got);
+		size_t whole = filled / sizeof(employee) * sizeof(employee);
+		for (size_t offset = 0; offset < whole; offset += sizeof(employee)) {
+			employee person;
+			std::memcpy(&person, buffer.data() + offset, sizeof(employee));
+			printEmployeeRow(person);
+		}
+		cout.flush();
+
+		reporterAlive = reporterAlive && writeAll(toReporter.writeEnd, buffer.data(), whole);
+		std::memmove(buffer.data(), buffer.data() + whole, filled - whole);
+		filled -= whole;
+	}
+	closeHandle(fromCreator.readEnd);
+	closeHandle(toReporter.writeEnd);
 
-		std::string reportFileName;
-		double payPerHour;
+	int creatorCode = waitProcess(creator);
+	int reporterCode = waitProcess(reporter);
+	if (creatorCode != 0 || reporterCode != 0 || !reporterAlive) {
+		throw std::runtime_error("Конвейер Creator -> Reporter завершился с ошибкой");
+	}
+	printReportFile(reportFileName);
+}
 
-		cout << "Enter the name of the peport file:\n";
-		cin >> reportFileName;
-		cout << "Enter the payment per hour:\n";
-		cin >> payPerHour;
+int main(int argc, char* argv[]) {
 
-		std::string reportedToCmd = "Reporter.exe " + binFileName + " " + reportFileName + " " + std::to_string(payPerHour);
-		runProcess(reportedToCmd);
-		printReportFile(reportFileName);
+	std::iostream::sync_with_stdio(false);
+	std::cin.tie(0);
+	std::cout.tie(0);
+
+	bool pipeline = false;
+	bool spawn = false;
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "--pipeline") {
+			pipeline = true;
+		}
+		else if (arg == "--spawn") {
+			spawn = true;
+		}
+		else if (arg == "--head" && i + 1 < argc && parseNumber(argv[i + 1], dumpRange.head)) {
+			i++;
+		}
+		else if (arg == "--tail" && i + 1 < argc && parseNumber(argv[i + 1], dumpRange.tail)) {
+			i++;
+		}
+		else {
+			cout << "Usage: Main [--spawn | --pipeline] [--head N] [--tail N]\n";
+			return 1;
+		}
+	}
+
+	try {
+		if (pipeline) {
+			runPipeline();
+		}
+		else {
+			runSequential(spawn);
+		}
 	}
 	catch (const std::exception& exp) {
 
@@ -1,52 +1,40 @@
 ﻿#include <iostream>
-#include <fstream>
-#include <string>
-#include <iomanip>
-#include "employee.h"
+#include <chrono>
+#include "employee_io.h"
 
 int main(int argc, char* argv[]) {
    std::iostream::sync_with_stdio(false);
    std::cin.tie(0);
    std::cout.tie(0);
 
-   using std::string;
-   using std::cin;
    using std::cout;
 
-   string binFileName = argv[1];
-   string reportFileName = argv[2];
-   double xPerHour = std::stod(argv[3]);
-
-   std::ifstream in(binFileName, std::ios::binary);
-   if (!in) {
-      cout << "Error: cannot open file " << binFileName << " for reading\n";
+   ReporterOptions options;
+   if (!parseReporterArguments(argc, argv, options)) {
+      cout << "Usage: Reporter <binary file>... <report file> <payment per hour> [--merge] [--mmap] [--threads N]\n"
+         "       [--io pread|uring] [--direct] [--sort num|name|salary] [--mem SIZE] [--summary] [--top K]\n"
+         "       [--incremental] [--follow] [--lookup ID,ID,...|@file] [--label NAME] [--format text|csv|jsonl|binary]\n"
+         "       [--rates FILE] [--exact] [--stats]\n"
+         "Binary file \"-\" reads records from standard input as they arrive.\n"
+         "--incremental appends only the records added since the last run (checkpoint in <report file>.ckpt).\n"
+         "--follow keeps appending rows for records added to the binary file until it is removed or renamed.\n"
+         "Several binary files give one report: their rows one file after another, or merged by num with --merge,\n"
+         "followed by subtotals per file.\n"
+         "--rates reads \"num,rate\" lines; employees missing from it are paid <payment per hour>.\n"
+         "Files written by Creator --checksum are verified against <binary file>.crc.\n";
       return 1;
    }
 
-   // Открываем текстовый файл для отчёта
-   std::ofstream out(reportFileName);
-   if (!out) {
-      cout << "Error: cannot open file " << reportFileName << " for writing\n";
+   auto start = std::chrono::steady_clock::now();
+   long long count = generateReport(options);
+   if (count < 0) {
       return 1;
    }
 
-   out << "\tReport on the file \"" << binFileName << "\":\n";
-   out << std::left << std::setw(15) << "Employee ID";
-   out << std::left << std::setw(15) << "Employee name";
-   out << std::left << std::setw(15) << "Employee hours";
-   out << std::left << std::setw(15) << "Employee salary\n";
-   
-   employee person;
-   while (in.read(reinterpret_cast<char*>(&person), sizeof(employee))) {
-      double salary = person.hours * xPerHour;
-      out << std::left << std::setw(15) << person.num
-          << std::setw(15) << person.name
-          <<std:: setw(15) << person.hours
-          << std::setw(15) << std::fixed << std::setprecision(2) << salary
-          << "\n";
+   if (options.printStats) {
+      double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      cout << "Processed " << count << " records in " << seconds << " s ("
+           << (seconds > 0 ? count / seconds : 0.0) << " records/s)\n";
    }
-
-   in.close();
-   out.close();
    return 0;
-}
\ No newline at end of file
+}
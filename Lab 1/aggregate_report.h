@@ -0,0 +1,291 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "employee.h"
+#include "employee_file.h"
+#include "rate_table.h"
+#include "money.h"
+
+// Агрегаты для сводного отчёта, которые считаются за один проход и
+// объединяются между потоками: итоги, K самых высоких зарплат (куча
+// размера K) и квантили часов (скетч с ограниченным числом корзин).
+
+// Квантильный скетч с относительной погрешностью QUANTILE_ACCURACY:
+// значение x попадает в корзину ceil(log_gamma |x|), и любой квантиль
+// восстанавливается с ошибкой не больше 1% от своего значения. Если корзин
+// становится больше MAX_BUCKETS, самые младшие сливаются в одну, поэтому
+// память ограничена независимо от размера файла.
+class QuantileSketch {
+public:
+   static constexpr double QUANTILE_ACCURACY = 0.01;
+   static constexpr size_t MAX_BUCKETS = 2048;
+   // Значения по модулю меньше этого считаются нулём.
+   static constexpr double MIN_VALUE = 1e-9;
+
+   // NaN и бесконечность в корзины не попадают (у них нет логарифма),
+   // а только подсчитываются.
+   void add(double value) {
+      if (!std::isfinite(value)) {
+         nonFiniteCount++;
+         return;
+      }
+      total++;
+      if (std::fabs(value) < MIN_VALUE) {
+         zeroCount++;
+      }
+      else if (value > 0) {
+         positive.add(bucketIndex(value), 1);
+      }
+      else {
+         negative.add(bucketIndex(-value), 1);
+      }
+   }
+
+   void merge(const QuantileSketch& other) {
+      total += other.total;
+      nonFiniteCount += other.nonFiniteCount;
+      zeroCount += other.zeroCount;
+      positive.merge(other.positive);
+      negative.merge(other.negative);
+   }
+
+   uint64_t count() const { return total; }
+   uint64_t nonFinite() const { return nonFiniteCount; }
+
+   // q в [0, 1]; count() не должен быть нулём.
+   double quantile(double q) const {
+      uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(total - 1));
+      uint64_t seen = 0;
+      for (size_t i = negative.bins.size(); i-- > 0;) {
+         seen += negative.bins[i];
+         if (seen > rank) {
+            return -bucketValue(negative.offset + static_cast<int>(i));
+         }
+      }
+      seen += zeroCount;
+      if (seen > rank) {
+         return 0.0;
+      }
+      for (size_t i = 0; i < positive.bins.size(); i++) {
+         seen += positive.bins[i];
+         if (seen > rank) {
+            return bucketValue(positive.offset + static_cast<int>(i));
+         }
+      }
+      return bucketValue(positive.offset + static_cast<int>(positive.bins.size()) - 1);
+   }
+
+private:
+   struct Store {
+      int offset = 0;
+      std::vector<uint64_t> bins;
+
+      void add(int index, uint64_t n) {
+         if (bins.empty()) {
+            offset = index;
+            bins.assign(1, 0);
+         }
+         if (index < offset) {
+            if (bins.size() + static_cast<size_t>(offset - index) > MAX_BUCKETS) {
+               index = offset;
+            }
+            else {
+               bins.insert(bins.begin(), static_cast<size_t>(offset - index), 0);
+               offset = index;
+            }
+         }
+         size_t position = static_cast<size_t>(index - offset);
+         if (position >= bins.size()) {
+            bins.resize(position + 1, 0);
+            if (bins.size() > MAX_BUCKETS) {
+               size_t excess = bins.size() - MAX_BUCKETS;
+               for (size_t i = 0; i < excess; i++) {
+                  bins[excess] += bins[i];
+               }
+               bins.erase(bins.begin(), bins.begin() + excess);
+               offset += static_cast<int>(excess);
+               position -= excess;
+            }
+         }
+         bins[position] += n;
+      }
+
+      void merge(const Store& other) {
+         for (size_t i = 0; i < other.bins.size(); i++) {
+            if (other.bins[i] != 0) {
+               add(other.offset + static_cast<int>(i), other.bins[i]);
+            }
+         }
+      }
+   };
+
+   static double gamma() {
+      return (1 + QUANTILE_ACCURACY) / (1 - QUANTILE_ACCURACY);
+   }
+
+   static int bucketIndex(double value) {
+      static const double logGamma = std::log(gamma());
+      return static_cast<int>(std::ceil(std::log(value) / logGamma));
+   }
+
+   // Середина корзины (gamma^(i-1), gamma^i] в смысле относительной ошибки.
+   static double bucketValue(int index) {
+      return 2 * std::pow(gamma(), index) / (gamma() + 1);
+   }
+
+   uint64_t total = 0;
+   uint64_t nonFiniteCount = 0;
+   uint64_t zeroCount = 0;
+   Store positive;
+   Store negative;
+};
+
+struct TopEarner {
+   double salary;
+   uint64_t record;
+   employee person;
+};
+
+// K самых больших зарплат; из равных остаётся более ранняя запись.
+class TopEarners {
+public:
+   explicit TopEarners(size_t limit = 0) : limit(limit) {}
+
+   // Дешёвая проверка до чтения самой записи. NaN не принимается никогда:
+   // ему нет места в порядке better().
+   bool accepts(double salary, uint64_t record) const {
+      return limit > 0 && !std::isnan(salary) && (heap.size() < limit || better({ salary, record, {} }, heap.front()));
+   }
+
+   void add(double salary, uint64_t record, const employee& person) {
+      if (!accepts(salary, record)) {
+         return;
+      }
+      heap.push_back({ salary, record, person });
+      std::push_heap(heap.begin(), heap.end(), better);
+      if (heap.size() > limit) {
+         std::pop_heap(heap.begin(), heap.end(), better);
+         heap.pop_back();
+      }
+   }
+
+   void merge(const TopEarners& other) {
+      for (const TopEarner& entry : other.heap) {
+         add(entry.salary, entry.record, entry.person);
+      }
+   }
+
+   // Лучшие первыми.
+   std::vector<TopEarner> sorted() const {
+      std::vector<TopEarner> result = heap;
+      std::sort(result.begin(), result.end(), better);
+      return result;
+   }
+
+private:
+   // В куче наверху лежит худший из отобранных.
+   static bool better(const TopEarner& a, const TopEarner& b) {
+      return a.salary != b.salary ? a.salary > b.salary : a.record < b.record;
+   }
+
+   size_t limit;
+   std::vector<TopEarner> heap;
+};
+
+struct EmployeeAggregate {
+   explicit EmployeeAggregate(size_t topCount = 0) : top(topCount) {}
+
+   void add(const employee& person, uint64_t record, double salary) {
+      count++;
+      totalHours += person.hours;
+      totalSalary += salary;
+      minHours = std::min(minHours, person.hours);
+      maxHours = std::max(maxHours, person.hours);
+      hours.add(person.hours);
+      top.add(salary, record, person);
+   }
+
+   void merge(const EmployeeAggregate& other) {
+      count += other.count;
+      totalHours += other.totalHours;
+      totalSalary += other.totalSalary;
+      totalCents += other.totalCents;
+      moneyOutOfRange = moneyOutOfRange || other.moneyOutOfRange;
+      minHours = std::min(minHours, other.minHours);
+      maxHours = std::max(maxHours, other.maxHours);
+      hours.merge(other.hours);
+      top.merge(other.top);
+   }
+
+   uint64_t count = 0;
+   double totalHours = 0.0;
+   double totalSalary = 0.0;
+   // Точная сумма зарплат в копейках (только при exact в aggregateRange).
+   int64_t totalCents = 0;
+   // Зарплата хотя бы одной записи не помещается в копейки (см. money.h).
+   bool moneyOutOfRange = false;
+   double minHours = std::numeric_limits<double>::infinity();
+   double maxHours = -std::numeric_limits<double>::infinity();
+   QuantileSketch hours;
+   TopEarners top;
+};
+
+inline void addCents(EmployeeAggregate& result, int64_t cents) {
+   result.moneyOutOfRange = result.moneyOutOfRange || cents == MONEY_INVALID;
+   result.totalCents += cents == MONEY_INVALID ? 0 : cents;
+}
+
+// Сводка по записям [first, last). В колоночном файле просматривается только
+// столбец hours; запись целиком собирается лишь для кандидатов в top-K.
+// С rates зарплаты считаются по таблице ставок (xPerHour - ставка по
+// умолчанию). С exact итог считается ещё и в копейках (totalCents).
+inline void aggregateRange(const EmployeeFile& file, uint64_t first, uint64_t last, double xPerHour,
+   EmployeeAggregate& result, const RateTable* rates = nullptr, bool exact = false) {
+   int64_t rateCents = toHundredths(xPerHour);
+   if (file.isColumnar() && rates == nullptr) {
+      const ColumnarView& columns = file.columns();
+      while (first < last) {
+         size_t blockIndex = static_cast<size_t>(first / columns.blockRecords());
+         size_t row = static_cast<size_t>(first % columns.blockRecords());
+         size_t take = static_cast<size_t>(std::min<uint64_t>(last - first, columns.block(blockIndex).count - row));
+         const double* hours = columns.hours(blockIndex) + row;
+         for (size_t i = 0; i < take; i++) {
+            double salary = hours[i] * xPerHour;
+            result.count++;
+            result.totalHours += hours[i];
+            result.totalSalary += salary;
+            result.minHours = std::min(result.minHours, hours[i]);
+            result.maxHours = std::max(result.maxHours, hours[i]);
+            result.hours.add(hours[i]);
+            if (exact) {
+               addCents(result, salaryCents(hours[i], rateCents));
+            }
+            if (result.top.accepts(salary, first + i)) {
+               employee person;
+               file.read(first + i, 1, &person);
+               result.top.add(salary, first + i, person);
+            }
+         }
+         first += take;
+      }
+      return;
+   }
+
+   constexpr size_t BATCH = 4096;
+   std::vector<employee> batch(BATCH);
+   for (uint64_t i = first; i < last; i += BATCH) {
+      size_t n = static_cast<size_t>(std::min<uint64_t>(BATCH, last - i));
+      file.read(i, n, batch.data());
+      for (size_t j = 0; j < n; j++) {
+         double rate = rates != nullptr ? rates->rate(batch[j].num, xPerHour) : xPerHour;
+         result.add(batch[j], i + j, batch[j].hours * rate);
+         if (exact) {
+            addCents(result, salaryCents(batch[j].hours, rates != nullptr ? toHundredths(rate) : rateCents));
+         }
+      }
+   }
+}
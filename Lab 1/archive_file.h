@@ -0,0 +1,486 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "employee.h"
+
+// Сжатый архив сотрудников (версия 1):
+//
+//   ArchiveHeader
+//   блок 0: LZ-сжатые данные ARCHIVE_BLOCK_RECORDS записей
+//   блок 1: ...
+//   словарь имён: name[dictionaryCount][10]
+//   ArchiveBlockInfo[blockCount] - индекс блоков с min/max по num
+//
+// До сжатия блок - три потока varint подряд: разности соседних num
+// (zigzag), номера имён в словаре и часы. Часы с точностью до сотых
+// хранятся как целое число сотых, остальные - как 8 байт double.
+// По индексу блоков поиск по num распаковывает только подходящие блоки.
+
+constexpr char ARCHIVE_MAGIC[4] = { 'E', 'M', 'P', 'Z' };
+constexpr uint32_t ARCHIVE_VERSION = 1;
+constexpr uint32_t ARCHIVE_BLOCK_RECORDS = 1 << 14;
+constexpr size_t ARCHIVE_NAME_SIZE = sizeof(employee::name);
+// Наибольший размер записи до сжатия: три varint по 10 байт.
+constexpr uint64_t ARCHIVE_MAX_RECORD_BYTES = 30;
+
+struct ArchiveHeader {
+   char magic[4];
+   uint32_t version;
+   uint32_t blockRecords;
+   uint32_t reserved;
+   uint64_t recordCount;
+   uint64_t blockCount;
+   uint64_t dictionaryOffset;
+   uint64_t dictionaryCount;
+   uint64_t indexOffset;
+};
+
+// compressedSize == rawSize - блок хранится несжатым.
+struct ArchiveBlockInfo {
+   uint64_t offset;
+   uint32_t compressedSize;
+   uint32_t rawSize;
+   uint32_t count;
+   int32_t minNum;
+   int32_t maxNum;
+   uint32_t reserved;
+};
+
+inline void putVarint(std::vector<unsigned char>& out, uint64_t value) {
+   while (value >= 0x80) {
+      out.push_back(static_cast<unsigned char>(value | 0x80));
+      value >>= 7;
+   }
+   out.push_back(static_cast<unsigned char>(value));
+}
+
+inline bool getVarint(const unsigned char*& p, const unsigned char* end, uint64_t& value) {
+   value = 0;
+   for (int shift = 0; shift < 64 && p < end; shift += 7) {
+      unsigned char byte = *p++;
+      value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+      if ((byte & 0x80) == 0) {
+         return true;
+      }
+   }
+   return false;
+}
+
+inline uint64_t zigzagEncode(int64_t value) {
+   return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t zigzagDecode(uint64_t value) {
+   return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+// Часы, которые точно восстанавливаются из целого числа сотых, пишутся
+// как (zigzag(сотые) << 1), прочие - как 1 и 8 байт double.
+inline void putHours(std::vector<unsigned char>& out, double hours) {
+   if (std::fabs(hours) < 1e15) {
+      long long cents = std::llround(hours * 100.0);
+      double restored = static_cast<double>(cents) / 100.0;
+      if (std::memcmp(&restored, &hours, sizeof(double)) == 0) {
+         putVarint(out, zigzagEncode(cents) << 1);
+         return;
+      }
+   }
+   out.push_back(1);
+   const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&hours);
+   out.insert(out.end(), bytes, bytes + sizeof(double));
+}
+
+inline bool getHours(const unsigned char*& p, const unsigned char* end, double& hours) {
+   uint64_t value;
+   if (!getVarint(p, end, value)) {
+      return false;
+   }
+   if ((value & 1) == 0) {
+      hours = static_cast<double>(zigzagDecode(value >> 1)) / 100.0;
+      return true;
+   }
+   if (end - p < static_cast<ptrdiff_t>(sizeof(double))) {
+      return false;
+   }
+   std::memcpy(&hours, p, sizeof(double));
+   p += sizeof(double);
+   return true;
+}
+
+// LZ77 в духе LZ4: последовательность = байт-токен (длина литералов в старшей
+// тетраде, длина совпадения - 4 в младшей, 15 - продолжение байтами до
+// первого не-255), литералы, смещение совпадения (2 байта). Последняя
+// последовательность состоит только из литералов.
+constexpr size_t LZ_MIN_MATCH = 4;
+constexpr size_t LZ_MAX_OFFSET = 0xFFFF;
+constexpr size_t LZ_HASH_BITS = 14;
+
+inline void putLzLength(std::vector<unsigned char>& out, size_t length) {
+   while (length >= 255) {
+      out.push_back(255);
+      length -= 255;
+   }
+   out.push_back(static_cast<unsigned char>(length));
+}
+
+inline void putLzSequence(std::vector<unsigned char>& out, const unsigned char* literals,
+   size_t literalLength, size_t matchLength, size_t offset) {
+   size_t matchCode = matchLength >= LZ_MIN_MATCH ? matchLength - LZ_MIN_MATCH : 0;
+   unsigned char token = static_cast<unsigned char>((std::min<size_t>(literalLength, 15) << 4)
+      | std::min<size_t>(matchCode, 15));
+   out.push_back(token);
+   if (literalLength >= 15) {
+      putLzLength(out, literalLength - 15);
+   }
+   out.insert(out.end(), literals, literals + literalLength);
+   if (matchLength >= LZ_MIN_MATCH) {
+      out.push_back(static_cast<unsigned char>(offset));
+      out.push_back(static_cast<unsigned char>(offset >> 8));
+      if (matchCode >= 15) {
+         putLzLength(out, matchCode - 15);
+      }
+   }
+}
+
+inline void lzCompress(const unsigned char* data, size_t size, std::vector<unsigned char>& out) {
+   out.clear();
+   std::vector<uint32_t> table(size_t(1) << LZ_HASH_BITS, UINT32_MAX);
+   size_t anchor = 0;
+   size_t i = 0;
+   while (i + LZ_MIN_MATCH <= size) {
+      uint32_t word;
+      std::memcpy(&word, data + i, sizeof(word));
+      uint32_t hash = (word * 2654435761u) >> (32 - LZ_HASH_BITS);
+      uint32_t candidate = table[hash];
+      table[hash] = static_cast<uint32_t>(i);
+      if (candidate == UINT32_MAX || i - candidate > LZ_MAX_OFFSET
+         || std::memcmp(data + candidate, data + i, LZ_MIN_MATCH) != 0) {
+         i++;
+         continue;
+      }
+      size_t length = LZ_MIN_MATCH;
+      while (i + length < size && data[candidate + length] == data[i + length]) {
+         length++;
+      }
+      putLzSequence(out, data + anchor, i - anchor, length, i - candidate);
+      i += length;
+      anchor = i;
+   }
+   putLzSequence(out, data + anchor, size - anchor, 0, 0);
+}
+
+// false, если вход повреждён или распаковывается не ровно в rawSize байт.
+inline bool lzDecompress(const unsigned char* p, size_t size, unsigned char* out, size_t rawSize) {
+   const unsigned char* end = p + size;
+   size_t written = 0;
+   auto readLength = [&](size_t& length) {
+      unsigned char byte;
+      do {
+         if (p >= end) {
+            return false;
+         }
+         byte = *p++;
+         length += byte;
+      } while (byte == 255);
+      return true;
+   };
+
+   while (p < end) {
+      unsigned char token = *p++;
+      size_t literalLength = token >> 4;
+      if (literalLength == 15 && !readLength(literalLength)) {
+         return false;
+      }
+      if (literalLength > static_cast<size_t>(end - p) || literalLength > rawSize - written) {
+         return false;
+      }
+      std::memcpy(out + written, p, literalLength);
+      p += literalLength;
+      written += literalLength;
+      if (p == end) {
+         break;
+      }
+
+      if (end - p < 2) {
+         return false;
+      }
+      size_t offset = p[0] | (p[1] << 8);
+      p += 2;
+      size_t matchLength = token & 15;
+      if (matchLength == 15 && !readLength(matchLength)) {
+         return false;
+      }
+      matchLength += LZ_MIN_MATCH;
+      if (offset == 0 || offset > written || matchLength > rawSize - written) {
+         return false;
+      }
+      // Совпадение может перекрывать само себя, поэтому копируем побайтно.
+      for (size_t k = 0; k < matchLength; k++) {
+         out[written + k] = out[written - offset + k];
+      }
+      written += matchLength;
+   }
+   return written == rawSize;
+}
+
+// Копит записи и пишет их сжатыми блоками.
+class ArchiveWriter {
+public:
+   bool open(const std::string& fileName) {
+      out.open(fileName, std::ios::binary | std::ios::trunc);
+      ArchiveHeader header = {};
+      out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+      offset = sizeof(header);
+      return static_cast<bool>(out);
+   }
+
+   void add(const employee& person) {
+      pending.push_back(person);
+      if (pending.size() == ARCHIVE_BLOCK_RECORDS) {
+         flushBlock();
+      }
+   }
+
+   bool close() {
+      flushBlock();
+      ArchiveHeader header = {};
+      std::memcpy(header.magic, ARCHIVE_MAGIC, sizeof(header.magic));
+      header.version = ARCHIVE_VERSION;
+      header.blockRecords = ARCHIVE_BLOCK_RECORDS;
+      header.recordCount = recordCount;
+      header.blockCount = index.size();
+      header.dictionaryOffset = offset;
+      header.dictionaryCount = dictionary.size() / ARCHIVE_NAME_SIZE;
+      header.indexOffset = offset + dictionary.size();
+      out.write(dictionary.data(), dictionary.size());
+      out.write(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(ArchiveBlockInfo));
+      out.seekp(0);
+      out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+      out.close();
+      return !out.fail();
+   }
+
+private:
+   uint64_t nameId(const employee& person) {
+      // Байты после завершающего нуля не хранятся: в исходной записи там
+      // мог остаться мусор со стека.
+      std::string name(ARCHIVE_NAME_SIZE, '\0');
+      size_t length = std::find(person.name, person.name + ARCHIVE_NAME_SIZE, '\0') - person.name;
+      std::memcpy(&name[0], person.name, length);
+      auto found = names.find(name);
+      if (found != names.end()) {
+         return found->second;
+      }
+      uint64_t id = names.size();
+      names.emplace(name, id);
+      dictionary.insert(dictionary.end(), name.begin(), name.end());
+      return id;
+   }
+
+   void flushBlock() {
+      size_t count = pending.size();
+      if (count == 0) {
+         return;
+      }
+      raw.clear();
+      int64_t previous = 0;
+      for (const employee& person : pending) {
+         putVarint(raw, zigzagEncode(person.num - previous));
+         previous = person.num;
+      }
+      for (const employee& person : pending) {
+         putVarint(raw, nameId(person));
+      }
+      for (const employee& person : pending) {
+         putHours(raw, person.hours);
+      }
+
+      lzCompress(raw.data(), raw.size(), packed);
+      const std::vector<unsigned char>& stored = packed.size() < raw.size() ? packed : raw;
+
+      ArchiveBlockInfo info = {};
+      info.offset = offset;
+      info.compressedSize = static_cast<uint32_t>(stored.size());
+      info.rawSize = static_cast<uint32_t>(raw.size());
+      info.count = static_cast<uint32_t>(count);
+      auto numRange = std::minmax_element(pending.begin(), pending.end(),
+         [](const employee& a, const employee& b) { return a.num < b.num; });
+      info.minNum = numRange.first->num;
+      info.maxNum = numRange.second->num;
+      index.push_back(info);
+
+      out.write(reinterpret_cast<const char*>(stored.data()), stored.size());
+      offset += stored.size();
+      recordCount += count;
+      pending.clear();
+   }
+
+   std::ofstream out;
+   std::vector<employee> pending;
+   std::vector<unsigned char> raw;
+   std::vector<unsigned char> packed;
+   std::unordered_map<std::string, uint64_t> names;
+   std::vector<char> dictionary;
+   std::vector<ArchiveBlockInfo> index;
+   uint64_t offset = 0;
+   uint64_t recordCount = 0;
+};
+
+// Просмотр архива, уже загруженного или отображённого в память, только для
+// чтения. Распакованные блоки кэшируются в каждом потоке отдельно, поэтому
+// несколько потоков могут читать разные диапазоны одного просмотра сразу.
+class ArchiveView {
+public:
+   // false, если в data нет правильного архива.
+   bool attach(const char* data, size_t size) {
+      if (size < sizeof(ArchiveHeader)) {
+         return false;
+      }
+      std::memcpy(&header, data, sizeof(header));
+      if (std::memcmp(header.magic, ARCHIVE_MAGIC, sizeof(header.magic)) != 0
+         || header.version != ARCHIVE_VERSION
+         || header.blockRecords == 0
+         || header.dictionaryOffset > header.indexOffset
+         || (header.indexOffset - header.dictionaryOffset) / ARCHIVE_NAME_SIZE != header.dictionaryCount
+         || header.indexOffset > size
+         || (size - header.indexOffset) / sizeof(ArchiveBlockInfo) != header.blockCount
+         || (size - header.indexOffset) % sizeof(ArchiveBlockInfo) != 0) {
+         return false;
+      }
+      base = data;
+      blocks = reinterpret_cast<const ArchiveBlockInfo*>(data + header.indexOffset);
+      // Запись ищется как first / blockRecords, поэтому все блоки, кроме
+      // последнего, должны быть полными, а сумма - совпадать с recordCount.
+      uint64_t records = 0;
+      for (uint64_t b = 0; b < header.blockCount; b++) {
+         const ArchiveBlockInfo& info = blocks[b];
+         bool last = b + 1 == header.blockCount;
+         if (info.offset < sizeof(ArchiveHeader) || info.offset > header.dictionaryOffset
+            || info.compressedSize > header.dictionaryOffset - info.offset
+            || info.count == 0 || info.count > header.blockRecords
+            || (!last && info.count != header.blockRecords)
+            || info.rawSize > info.count * ARCHIVE_MAX_RECORD_BYTES
+            || info.compressedSize > info.rawSize) {
+            return false;
+         }
+         records += info.count;
+      }
+      if (records != header.recordCount) {
+         return false;
+      }
+      generation = nextGeneration()++;
+      damaged = false;
+      return true;
+   }
+
+   uint64_t recordCount() const { return header.recordCount; }
+   uint64_t blockCount() const { return header.blockCount; }
+   uint32_t blockRecords() const { return header.blockRecords; }
+   const ArchiveBlockInfo& block(size_t i) const { return blocks[i]; }
+
+   // Распаковывает блок i в out[0, block(i).count). Для повреждённого
+   // блока возвращает false.
+   bool decodeBlock(size_t i, employee* out) const {
+      const ArchiveBlockInfo& info = blocks[i];
+      const unsigned char* stored = reinterpret_cast<const unsigned char*>(base + info.offset);
+      std::vector<unsigned char> unpacked;
+      const unsigned char* p = stored;
+      if (info.compressedSize != info.rawSize) {
+         unpacked.resize(info.rawSize);
+         if (!lzDecompress(stored, info.compressedSize, unpacked.data(), info.rawSize)) {
+            return false;
+         }
+         p = unpacked.data();
+      }
+      const unsigned char* end = p + info.rawSize;
+      const char* dictionary = base + header.dictionaryOffset;
+
+      std::memset(out, 0, info.count * sizeof(employee));
+      int64_t num = 0;
+      uint64_t value;
+      for (uint32_t r = 0; r < info.count; r++) {
+         if (!getVarint(p, end, value)) {
+            return false;
+         }
+         num += zigzagDecode(value);
+         out[r].num = static_cast<int>(num);
+      }
+      for (uint32_t r = 0; r < info.count; r++) {
+         if (!getVarint(p, end, value) || value >= header.dictionaryCount) {
+            return false;
+         }
+         std::memcpy(out[r].name, dictionary + value * ARCHIVE_NAME_SIZE, ARCHIVE_NAME_SIZE);
+      }
+      for (uint32_t r = 0; r < info.count; r++) {
+         if (!getHours(p, end, out[r].hours)) {
+            return false;
+         }
+      }
+      return p == end;
+   }
+
+   // Копирует записи [first, first + n) в out. false, если блок повреждён
+   // (его записи читаются нулями); isDamaged() это запоминает.
+   bool read(uint64_t first, size_t n, employee* out) const {
+      BlockCache& cache = blockCache();
+      bool ok = true;
+      while (n > 0) {
+         size_t blockIndex = static_cast<size_t>(first / header.blockRecords);
+         size_t row = static_cast<size_t>(first % header.blockRecords);
+         if (cache.generation != generation || cache.block != blockIndex) {
+            cache.records.resize(blocks[blockIndex].count);
+            if (decodeBlock(blockIndex, cache.records.data())) {
+               cache.generation = generation;
+               cache.block = blockIndex;
+            }
+            else {
+               std::fill(cache.records.begin(), cache.records.end(), employee{});
+               cache.generation = 0;
+               damaged = true;
+               ok = false;
+            }
+         }
+         size_t take = std::min<size_t>(n, blocks[blockIndex].count - row);
+         std::memcpy(out, cache.records.data() + row, take * sizeof(employee));
+         out += take;
+         first += take;
+         n -= take;
+      }
+      return ok;
+   }
+
+   bool isDamaged() const { return damaged; }
+
+private:
+   struct BlockCache {
+      uint64_t generation = 0;
+      size_t block = 0;
+      std::vector<employee> records;
+   };
+
+   static BlockCache& blockCache() {
+      thread_local BlockCache cache;
+      return cache;
+   }
+
+   // Каждый attach() получает свой номер, чтобы кэш потока не выдал блок
+   // другого (или переоткрытого) архива.
+   static std::atomic<uint64_t>& nextGeneration() {
+      static std::atomic<uint64_t> counter(1);
+      return counter;
+   }
+
+   ArchiveHeader header = {};
+   const char* base = nullptr;
+   const ArchiveBlockInfo* blocks = nullptr;
+   uint64_t generation = 0;
+   mutable std::atomic<bool> damaged{ false };
+};
@@ -0,0 +1,153 @@
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <set>
+#include <string>
+#include <vector>
+#include "employee_io.h"
+#include "employee_file.h"
+#include "mapped_file.h"
+#include "report_format.h"
+#include "salary_kernel.h"
+
+// Google Benchmark для конвейера Lab 1: генерация записей, чтение файла
+// (ifstream и mmap), расчёт зарплат и форматирование отчёта на 10^3..10^8
+// записях. По умолчанию результаты дополнительно пишутся в
+// employee_bench.json; отдельные замеры выбираются --benchmark_filter.
+
+constexpr int64_t MIN_RECORDS = 1000;
+constexpr int64_t MAX_RECORDS = 100000000;
+
+std::set<std::string> createdFiles;
+
+// Файл с count синтетическими записями, общий для всех замеров чтения.
+std::string dataFile(int64_t count) {
+   std::string fileName = "employee_bench_" + std::to_string(count) + ".bin";
+   if (createdFiles.insert(fileName).second) {
+      CreatorOptions options;
+      options.fileName = fileName;
+      options.count = static_cast<unsigned long long>(count);
+      options.source = CreatorSource::SYNTHETIC;
+      options.seed = 1;
+      createEmployees(options);
+   }
+   return fileName;
+}
+
+void setCounters(benchmark::State& state, int64_t count) {
+   state.SetItemsProcessed(state.iterations() * count);
+   state.SetBytesProcessed(state.iterations() * count * static_cast<int64_t>(sizeof(employee)));
+}
+
+void BM_Generate(benchmark::State& state) {
+   CreatorOptions options;
+   options.fileName = "employee_bench_generate.bin";
+   options.count = static_cast<unsigned long long>(state.range(0));
+   options.source = CreatorSource::SYNTHETIC;
+   options.seed = 1;
+   for (auto _ : state) {
+      if (createEmployees(options) != 0) {
+         state.SkipWithError("cannot write the data file");
+         break;
+      }
+   }
+   std::remove(options.fileName.c_str());
+   setCounters(state, state.range(0));
+}
+
+void BM_ReadStream(benchmark::State& state) {
+   std::string fileName = dataFile(state.range(0));
+   for (auto _ : state) {
+      std::ifstream in(fileName, std::ios::binary);
+      employee person;
+      double total = 0.0;
+      while (in.read(reinterpret_cast<char*>(&person), sizeof(employee))) {
+         total += person.hours;
+      }
+      benchmark::DoNotOptimize(total);
+   }
+   setCounters(state, state.range(0));
+}
+
+void BM_ReadMapped(benchmark::State& state) {
+   std::string fileName = dataFile(state.range(0));
+   for (auto _ : state) {
+      MappedFile file;
+      file.open(fileName);
+      double total = 0.0;
+      for (size_t offset = 0; offset + sizeof(employee) <= file.size(); offset += sizeof(employee)) {
+         double hours;
+         std::memcpy(&hours, file.data() + offset + offsetof(employee, hours), sizeof(double));
+         total += hours;
+      }
+      benchmark::DoNotOptimize(total);
+   }
+   setCounters(state, state.range(0));
+}
+
+void BM_Salary(benchmark::State& state) {
+   size_t count = static_cast<size_t>(state.range(0));
+   std::vector<double> hours(count), salaries(count);
+   for (size_t i = 0; i < count; i++) {
+      hours[i] = static_cast<double>(i % 1001) * 0.25;
+   }
+   for (auto _ : state) {
+      computeSalaries(hours.data(), salaries.data(), count, 12.5);
+      benchmark::ClobberMemory();
+   }
+   state.SetItemsProcessed(state.iterations() * state.range(0));
+   state.SetLabel(salaryKernel().name);
+}
+
+// Строки отчёта собираются кусками по 64K записей в один переиспользуемый
+// буфер, на диск ничего не пишется.
+void BM_FormatReport(benchmark::State& state) {
+   constexpr uint64_t CHUNK = 1 << 16;
+   EmployeeFile file;
+   file.open(dataFile(state.range(0)));
+   std::string rows;
+   for (auto _ : state) {
+      for (uint64_t first = 0; first < file.count(); first += CHUNK) {
+         rows.clear();
+         formatReportRange(file, first, std::min(file.count(), first + CHUNK), 12.5, rows);
+         benchmark::DoNotOptimize(rows.data());
+      }
+   }
+   setCounters(state, state.range(0));
+}
+
+#define EMPLOYEE_BENCHMARK(name) \
+   BENCHMARK(name)->RangeMultiplier(10)->Range(MIN_RECORDS, MAX_RECORDS)->Unit(benchmark::kMillisecond)
+
+EMPLOYEE_BENCHMARK(BM_Generate);
+EMPLOYEE_BENCHMARK(BM_ReadStream);
+EMPLOYEE_BENCHMARK(BM_ReadMapped);
+EMPLOYEE_BENCHMARK(BM_Salary);
+EMPLOYEE_BENCHMARK(BM_FormatReport);
+
+int main(int argc, char* argv[]) {
+   std::vector<char*> args(argv, argv + argc);
+   bool hasOutput = false;
+   for (int i = 1; i < argc; i++) {
+      hasOutput = hasOutput || std::strncmp(argv[i], "--benchmark_out=", 16) == 0;
+   }
+   char outFile[] = "--benchmark_out=employee_bench.json";
+   char outFormat[] = "--benchmark_out_format=json";
+   if (!hasOutput) {
+      args.push_back(outFile);
+      args.push_back(outFormat);
+   }
+   int count = static_cast<int>(args.size());
+   benchmark::Initialize(&count, args.data());
+   if (benchmark::ReportUnrecognizedArguments(count, args.data())) {
+      return 1;
+   }
+   benchmark::RunSpecifiedBenchmarks();
+   benchmark::Shutdown();
+
+   for (const std::string& fileName : createdFiles) {
+      std::remove(fileName.c_str());
+   }
+   return 0;
+}
@@ -0,0 +1,81 @@
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "employee_io.h"
+#include "process.h"
+
+// Сквозная задержка Creator -> Reporter: вызовы библиотеки employee_io
+// в одном процессе против запуска Creator/Reporter отдельными процессами.
+// Запускать из каталога сборки, где лежат исполняемые файлы утилит.
+
+constexpr int REPEATS = 5;
+
+double runInProcess(unsigned long long count) {
+   auto start = std::chrono::steady_clock::now();
+
+   CreatorOptions creatorOptions;
+   creatorOptions.fileName = "latency_bench.bin";
+   creatorOptions.count = count;
+   creatorOptions.source = CreatorSource::SYNTHETIC;
+   creatorOptions.seed = 1;
+   ReporterOptions reporterOptions;
+   reporterOptions.binFileName = creatorOptions.fileName;
+   reporterOptions.reportFileName = "latency_bench.txt";
+   reporterOptions.xPerHour = 10.0;
+   reporterOptions.useMapping = true;
+
+   if (createEmployees(creatorOptions) != 0 || generateReport(reporterOptions) < 0) {
+      return -1.0;
+   }
+   return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+double runSpawned(unsigned long long count) {
+   auto start = std::chrono::steady_clock::now();
+
+   ChildProcess creator, reporter;
+   if (!startProcess({ executableName("Creator"), "latency_bench.bin", std::to_string(count),
+      "--synthetic", "1" }, creator) || waitProcess(creator) != 0) {
+      return -1.0;
+   }
+   if (!startProcess({ executableName("Reporter"), "latency_bench.bin", "latency_bench.txt", "10",
+      "--mmap" }, reporter) || waitProcess(reporter) != 0) {
+      return -1.0;
+   }
+   return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+double bestOf(double (*run)(unsigned long long), unsigned long long count) {
+   double best = -1.0;
+   for (int i = 0; i < REPEATS; i++) {
+      double seconds = run(count);
+      if (seconds < 0) {
+         return -1.0;
+      }
+      if (best < 0 || seconds < best) {
+         best = seconds;
+      }
+   }
+   return best;
+}
+
+int main() {
+   std::iostream::sync_with_stdio(false);
+
+   std::cout << "Records      in-process, ms   spawned, ms\n";
+   for (unsigned long long count : { 10ull, 1000ull, 100000ull, 1000000ull }) {
+      double inProcess = bestOf(runInProcess, count);
+      double spawned = bestOf(runSpawned, count);
+      if (inProcess < 0 || spawned < 0) {
+         std::cout << "Error: run failed for " << count << " records\n";
+         return 1;
+      }
+      std::printf("%-12llu %-16.3f %.3f\n", count, inProcess * 1000, spawned * 1000);
+   }
+
+   std::remove("latency_bench.bin");
+   std::remove("latency_bench.txt");
+   return 0;
+}
@@ -0,0 +1,131 @@
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include "employee_io.h"
+#include "mapped_file.h"
+#include "block_reader.h"
+
+// Чтение файла сотрудников с холодным кэшем: ifstream, mmap, pread и
+// io_uring, обычное и мимо кэша страниц (O_DIRECT). Перед каждым прогоном
+// страницы файла выбрасываются из кэша (posix_fadvise DONTNEED), поэтому
+// измеряется чтение с диска.
+// Запуск: read_bench [количество записей, по умолчанию 10^7]
+
+constexpr int REPEATS = 3;
+const char* const FILE_NAME = "read_bench.bin";
+
+void dropCache(const std::string& fileName) {
+   int fd = open(fileName.c_str(), O_RDONLY);
+   if (fd >= 0) {
+      fdatasync(fd);
+      posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+      close(fd);
+   }
+}
+
+double readStream() {
+   std::ifstream in(FILE_NAME, std::ios::binary);
+   employee person;
+   double total = 0.0;
+   while (in.read(reinterpret_cast<char*>(&person), sizeof(employee))) {
+      total += person.hours;
+   }
+   return total;
+}
+
+double readMapped() {
+   MappedFile file;
+   file.open(FILE_NAME);
+   double total = 0.0;
+   for (size_t offset = 0; offset + sizeof(employee) <= file.size(); offset += sizeof(employee)) {
+      double hours;
+      std::memcpy(&hours, file.data() + offset + offsetof(employee, hours), sizeof(double));
+      total += hours;
+   }
+   return total;
+}
+
+// Сумма по блокам BlockReader; запись, разрезанная границей блока,
+// собирается из двух кусков.
+double readBlocks(IoMethod method, bool direct) {
+   BlockReader reader;
+   reader.open(FILE_NAME, method, direct);
+   char partial[sizeof(employee)];
+   size_t partialSize = 0;
+   double total = 0.0;
+   const char* data;
+   size_t size;
+   while (reader.next(data, size)) {
+      employee person;
+      size_t start = 0;
+      if (partialSize > 0) {
+         start = sizeof(employee) - partialSize;
+         std::memcpy(partial + partialSize, data, start);
+         std::memcpy(&person, partial, sizeof(employee));
+         total += person.hours;
+      }
+      size_t whole = start + (size - start) / sizeof(employee) * sizeof(employee);
+      for (size_t offset = start; offset < whole; offset += sizeof(employee)) {
+         std::memcpy(&person, data + offset, sizeof(employee));
+         total += person.hours;
+      }
+      partialSize = size - whole;
+      std::memcpy(partial, data + whole, partialSize);
+   }
+   return total;
+}
+
+template<class Read>
+void measure(const char* name, uint64_t bytes, Read read) {
+   double best = 1e300;
+   double checksum = 0.0;
+   for (int r = 0; r < REPEATS; r++) {
+      dropCache(FILE_NAME);
+      auto start = std::chrono::steady_clock::now();
+      checksum = read();
+      best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+   }
+   std::cout << std::left;
+   std::cout.width(17);
+   std::cout << name << best << " s, " << bytes / best / (1 << 20) << " MiB/s (checksum " << checksum << ")\n";
+}
+
+int main(int argc, char* argv[]) {
+   CreatorOptions creator;
+   creator.fileName = FILE_NAME;
+   creator.count = 10000000;
+   if (argc > 1 && !parseNumber(std::string(argv[1]), creator.count)) {
+      std::cout << "Error: invalid number of records " << argv[1] << "\n";
+      return 1;
+   }
+   creator.source = CreatorSource::SYNTHETIC;
+   creator.seed = 1;
+   if (createEmployees(creator) != 0) {
+      return 1;
+   }
+   uint64_t bytes = creator.count * sizeof(employee);
+
+   BlockReader probe;
+   probe.open(FILE_NAME, IoMethod::URING);
+   bool uring = probe.method() == IoMethod::URING;
+   probe.close();
+
+   std::cout << creator.count << " records, " << bytes / (1 << 20) << " MiB, best of " << REPEATS << " cold runs\n";
+   measure("ifstream", bytes, readStream);
+   measure("mmap", bytes, readMapped);
+   measure("pread", bytes, [] { return readBlocks(IoMethod::PREAD, false); });
+   measure("pread+direct", bytes, [] { return readBlocks(IoMethod::PREAD, true); });
+   if (uring) {
+      measure("io_uring", bytes, [] { return readBlocks(IoMethod::URING, false); });
+      measure("io_uring+direct", bytes, [] { return readBlocks(IoMethod::URING, true); });
+   }
+   else {
+      std::cout << "io_uring is not available\n";
+   }
+   std::remove(FILE_NAME);
+   return 0;
+}
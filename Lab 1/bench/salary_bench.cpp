@@ -0,0 +1,50 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "employee_io.h"
+#include "salary_kernel.h"
+
+// Сравнение скалярного и векторных вариантов ядра зарплат.
+// Запуск: salary_bench [количество значений, по умолчанию 10^8]
+
+double measure(SalaryKernel kernel, const std::vector<double>& hours, std::vector<double>& salaries) {
+   auto start = std::chrono::steady_clock::now();
+   kernel(hours.data(), salaries.data(), hours.size(), 12.5);
+   return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[]) {
+   size_t count = 100000000;
+   if (argc > 1 && !parseNumber(std::string(argv[1]), count)) {
+      std::cout << "Error: invalid number of values " << argv[1] << "\n";
+      return 1;
+   }
+   std::vector<double> hours(count);
+   std::vector<double> salaries(count);
+   for (size_t i = 0; i < count; i++) {
+      hours[i] = static_cast<double>(i % 1001) * 0.25;
+   }
+
+   std::vector<SalaryKernelInfo> kernels = { { "scalar", computeSalariesScalar } };
+#ifdef EMPLOYEE_X86
+   const CpuFeatures& features = cpuFeatures();
+   if (features.sse2) kernels.push_back({ "sse2", computeSalariesSse2 });
+   if (features.avx2) kernels.push_back({ "avx2", computeSalariesAvx2 });
+   if (features.avx512f) kernels.push_back({ "avx512", computeSalariesAvx512 });
+#endif
+
+   std::cout << "Values: " << count << ", dispatched kernel: " << salaryKernel().name << "\n";
+   std::vector<double> expected(count);
+   computeSalariesScalar(hours.data(), expected.data(), count, 12.5);
+
+   for (const SalaryKernelInfo& kernel : kernels) {
+      measure(kernel.kernel, hours, salaries);
+      double seconds = measure(kernel.kernel, hours, salaries);
+      bool same = salaries == expected;
+      std::cout << kernel.name << ": " << seconds << " s, " << count / seconds / 1e6 << " M values/s"
+         << (same ? "" : " (MISMATCH)") << "\n";
+   }
+   return 0;
+}
@@ -0,0 +1,523 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+// Последовательное чтение файла крупными блоками (--io, --direct). В Linux
+// через io_uring в полёте держится READ_QUEUE_DEPTH запросов, пока
+// вызывающий обрабатывает уже прочитанный блок; если io_uring недоступен
+// (или ядро старше 5.6 и не знает IORING_OP_READ), блоки читаются обычным
+// pread (ReadFile в Windows) одним фоновым потоком с двойной буферизацией.
+// Границы блоков не совпадают с границами записей: склеивать записи -
+// забота вызывающего.
+
+constexpr size_t READ_BLOCK_SIZE = 1 << 20;
+constexpr unsigned READ_QUEUE_DEPTH = 4;
+constexpr size_t READ_ALIGNMENT = 4096;
+
+enum class IoMethod {
+   DEFAULT,
+   PREAD,
+   URING
+};
+
+inline bool parseIoMethod(const std::string& text, IoMethod& method) {
+   if (text == "pread") method = IoMethod::PREAD;
+   else if (text == "uring") method = IoMethod::URING;
+   else return false;
+   return true;
+}
+
+struct AlignedDeleter {
+   void operator()(char* p) const {
+#ifdef _WIN32
+      _aligned_free(p);
+#else
+      std::free(p);
+#endif
+   }
+};
+
+using AlignedBuffer = std::unique_ptr<char, AlignedDeleter>;
+
+inline AlignedBuffer allocateAligned(size_t size) {
+#ifdef _WIN32
+   return AlignedBuffer(static_cast<char*>(_aligned_malloc(size, READ_ALIGNMENT)));
+#else
+   void* p = nullptr;
+   return AlignedBuffer(posix_memalign(&p, READ_ALIGNMENT, size) == 0 ? static_cast<char*>(p) : nullptr);
+#endif
+}
+
+#ifdef __linux__
+// Минимальное кольцо io_uring на голых системных вызовах (liburing не нужна).
+class IoUring {
+public:
+   IoUring() = default;
+   IoUring(const IoUring&) = delete;
+   IoUring& operator=(const IoUring&) = delete;
+   ~IoUring() { close(); }
+
+   bool open(unsigned entries) {
+      io_uring_params params = {};
+      ringFd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+      if (ringFd < 0) {
+         return false;
+      }
+      sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+      cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+      bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+      if (singleMap) {
+         sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+      }
+      sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+      cqRing = singleMap ? sqRing
+         : mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+      sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+      void* sqesMap = mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+      if (sqRing == MAP_FAILED || cqRing == MAP_FAILED || sqesMap == MAP_FAILED) {
+         if (sqesMap != MAP_FAILED) munmap(sqesMap, sqesSize);
+         if (cqRing == MAP_FAILED) cqRing = nullptr;
+         if (sqRing == MAP_FAILED) sqRing = nullptr;
+         close();
+         return false;
+      }
+      sqes = static_cast<io_uring_sqe*>(sqesMap);
+
+      char* sq = static_cast<char*>(sqRing);
+      sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+      sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+      sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+      char* cq = static_cast<char*>(cqRing);
+      cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+      cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+      cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+      cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+      if (!supports(IORING_OP_READ)) {
+         close();
+         return false;
+      }
+      return true;
+   }
+
+   void close() {
+      if (sqes != nullptr) munmap(sqes, sqesSize);
+      if (cqRing != nullptr && cqRing != sqRing) munmap(cqRing, cqRingSize);
+      if (sqRing != nullptr) munmap(sqRing, sqRingSize);
+      if (ringFd >= 0) ::close(ringFd);
+      sqes = nullptr;
+      sqRing = cqRing = nullptr;
+      ringFd = -1;
+   }
+
+   // Ставит в очередь одно чтение и сразу отправляет его.
+   bool submitRead(int fd, char* buffer, unsigned size, uint64_t offset, uint64_t tag) {
+      unsigned tail = *sqTail;
+      unsigned index = tail & sqMask;
+      io_uring_sqe& sqe = sqes[index];
+      std::memset(&sqe, 0, sizeof(sqe));
+      sqe.opcode = IORING_OP_READ;
+      sqe.fd = fd;
+      sqe.addr = reinterpret_cast<uint64_t>(buffer);
+      sqe.len = size;
+      sqe.off = offset;
+      sqe.user_data = tag;
+      sqArray[index] = index;
+      __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+      while (syscall(__NR_io_uring_enter, ringFd, 1, 0, 0, nullptr, 0) < 0) {
+         if (errno != EINTR) {
+            return false;
+         }
+      }
+      return true;
+   }
+
+   // Ждёт следующего завершения.
+   bool wait(uint64_t& tag, int& result) {
+      while (true) {
+         unsigned head = *cqHead;
+         if (head != __atomic_load_n(cqTail, __ATOMIC_ACQUIRE)) {
+            const io_uring_cqe& cqe = cqes[head & cqMask];
+            tag = cqe.user_data;
+            result = cqe.res;
+            __atomic_store_n(cqHead, head + 1, __ATOMIC_RELEASE);
+            return true;
+         }
+         if (syscall(__NR_io_uring_enter, ringFd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 && errno != EINTR) {
+            return false;
+         }
+      }
+   }
+
+private:
+   // IORING_REGISTER_PROBE появился в 5.6 вместе с IORING_OP_READ: если
+   // проба не удалась, операции чтения нет.
+   bool supports(unsigned op) const {
+      constexpr unsigned PROBE_OPS = 256;
+      std::vector<char> memory(sizeof(io_uring_probe) + PROBE_OPS * sizeof(io_uring_probe_op));
+      io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(memory.data());
+      if (syscall(__NR_io_uring_register, ringFd, IORING_REGISTER_PROBE, probe, PROBE_OPS) < 0) {
+         return false;
+      }
+      return op <= probe->last_op && op < probe->ops_len && (probe->ops[op].flags & IO_URING_OP_SUPPORTED) != 0;
+   }
+
+   int ringFd = -1;
+   void* sqRing = nullptr;
+   void* cqRing = nullptr;
+   size_t sqRingSize = 0;
+   size_t cqRingSize = 0;
+   size_t sqesSize = 0;
+   io_uring_sqe* sqes = nullptr;
+   unsigned* sqTail = nullptr;
+   unsigned sqMask = 0;
+   unsigned* sqArray = nullptr;
+   unsigned* cqHead = nullptr;
+   unsigned* cqTail = nullptr;
+   unsigned cqMask = 0;
+   io_uring_cqe* cqes = nullptr;
+};
+#endif
+
+// Выдаёт блоки файла по порядку. Блок, возвращённый next(), действителен
+// до следующего вызова; остальные буферы пула тем временем заполняются
+// (запросы io_uring или pread в потоке чтения).
+//
+// С direct файл читается мимо страничного кэша (O_DIRECT,
+// FILE_FLAG_NO_BUFFERING): смещения, размеры и буферы выровнены по
+// READ_ALIGNMENT, последний блок запрашивается с округлением вверх. Где
+// прямой ввод-вывод не поддерживается, страницы выбрасываются из кэша
+// через POSIX_FADV_DONTNEED сразу после обработки каждого блока.
+class BlockReader {
+public:
+   BlockReader() = default;
+   BlockReader(const BlockReader&) = delete;
+   BlockReader& operator=(const BlockReader&) = delete;
+   ~BlockReader() { close(); }
+
+   // С IoMethod::URING переходит на pread, если io_uring не настроить;
+   // method() и isDirect() сообщают, что используется на деле.
+   bool open(const std::string& fileName, IoMethod requested, bool direct = false) {
+      close();
+#ifdef _WIN32
+      DWORD flags = direct ? FILE_FLAG_NO_BUFFERING : FILE_FLAG_SEQUENTIAL_SCAN;
+      hFile = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+         NULL, OPEN_EXISTING, flags, NULL);
+      LARGE_INTEGER size;
+      if (hFile == INVALID_HANDLE_VALUE || !GetFileSizeEx(hFile, &size)) {
+         return false;
+      }
+      length = static_cast<uint64_t>(size.QuadPart);
+      directActive = direct;
+#else
+#ifdef O_DIRECT
+      if (direct) {
+         fd = ::open(fileName.c_str(), O_RDONLY | O_DIRECT);
+         directActive = fd >= 0;
+      }
+#endif
+      if (fd < 0) {
+         fd = ::open(fileName.c_str(), O_RDONLY);
+         dropPages = direct;
+      }
+      struct stat st;
+      if (fd < 0 || fstat(fd, &st) != 0) {
+         return false;
+      }
+      length = static_cast<uint64_t>(st.st_size);
+#endif
+      activeMethod = IoMethod::PREAD;
+#ifdef __linux__
+      if (requested == IoMethod::URING && ring.open(READ_QUEUE_DEPTH)) {
+         activeMethod = IoMethod::URING;
+      }
+#else
+      (void)requested;
+#endif
+      // pread: двойная буферизация, io_uring: READ_QUEUE_DEPTH запросов.
+      size_t slotCount = activeMethod == IoMethod::URING ? READ_QUEUE_DEPTH : 2;
+      slots.resize(slotCount);
+      for (Slot& slot : slots) {
+         slot.buffer = allocateAligned(READ_BLOCK_SIZE);
+         if (!slot.buffer) {
+            return false;
+         }
+      }
+      if (activeMethod == IoMethod::PREAD) {
+         stopping = false;
+         reader = std::thread(&BlockReader::readLoop, this);
+      }
+      for (size_t i = 0; i < slots.size() && !failed; i++) {
+         submit(i);
+      }
+      return true;
+   }
+
+   void close() {
+      // Поток чтения дочитывает текущий блок, остальные запросы отменяются.
+      if (reader.joinable()) {
+         {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            requests.clear();
+         }
+         wake.notify_all();
+         reader.join();
+      }
+#ifdef __linux__
+      // Пока запросы в полёте, ядро пишет в буферы: дожидаемся их.
+      while (activeMethod == IoMethod::URING && inFlight > 0) {
+         uint64_t tag;
+         int result;
+         if (!ring.wait(tag, result)) {
+            break;
+         }
+         inFlight--;
+      }
+      ring.close();
+#endif
+#ifdef _WIN32
+      if (hFile != INVALID_HANDLE_VALUE) {
+         CloseHandle(hFile);
+      }
+      hFile = INVALID_HANDLE_VALUE;
+#else
+      if (fd >= 0) {
+         ::close(fd);
+      }
+      fd = -1;
+#endif
+      slots.clear();
+      nextOffset = 0;
+      nextSlot = 0;
+      inFlight = 0;
+      returned = false;
+      directActive = false;
+      dropPages = false;
+      failed = false;
+   }
+
+   IoMethod method() const { return activeMethod; }
+   bool isDirect() const { return directActive; }
+   uint64_t size() const { return length; }
+   bool error() const { return failed; }
+
+   // false в конце файла или при ошибке чтения (см. error()).
+   bool next(const char*& data, size_t& size) {
+      if (failed || slots.empty()) {
+         return false;
+      }
+      // Буфер, отданный в прошлый раз, уже обработан - ставим в него
+      // чтение следующего блока.
+      if (returned) {
+         release(slots[previousSlot]);
+         submit(previousSlot);
+         returned = false;
+      }
+      Slot& slot = slots[nextSlot];
+      complete(nextSlot);
+      if (failed || slot.size == 0) {
+         return false;
+      }
+      data = slot.buffer.get();
+      size = slot.size;
+      previousSlot = nextSlot;
+      returned = true;
+      nextSlot = (nextSlot + 1) % slots.size();
+      return true;
+   }
+
+private:
+   struct Slot {
+      AlignedBuffer buffer;
+      uint64_t offset = 0;
+      size_t size = 0;
+      bool pending = false;
+      bool readOk = true;
+   };
+
+   size_t requestSize(size_t size) const {
+      return directActive ? (size + READ_ALIGNMENT - 1) / READ_ALIGNMENT * READ_ALIGNMENT : size;
+   }
+
+   // Читает size байт по смещению offset; в прямом режиме запрос округляется
+   // вверх (файл может кончиться раньше - для последнего блока это нормально).
+   bool readAt(char* buffer, size_t size, uint64_t offset) const {
+      size_t request = requestSize(size);
+      size_t done = 0;
+      while (done < size) {
+#ifdef _WIN32
+         OVERLAPPED position = {};
+         position.Offset = static_cast<DWORD>(offset + done);
+         position.OffsetHigh = static_cast<DWORD>((offset + done) >> 32);
+         DWORD got = 0;
+         if (!ReadFile(hFile, buffer + done, static_cast<DWORD>(request - done), &got, &position) || got == 0) {
+            return false;
+         }
+#else
+         ssize_t got = ::pread(fd, buffer + done, request - done, static_cast<off_t>(offset + done));
+         if (got < 0 && errno == EINTR) {
+            continue;
+         }
+         if (got <= 0) {
+            return false;
+         }
+#endif
+         done += static_cast<size_t>(got);
+      }
+      return true;
+   }
+
+   // Ячейка за концом файла остаётся с размером 0 и отмечает конец.
+   void submit(size_t index) {
+      Slot& slot = slots[index];
+      slot.offset = nextOffset;
+      slot.size = static_cast<size_t>(std::min<uint64_t>(READ_BLOCK_SIZE, length - nextOffset));
+      slot.pending = false;
+      if (slot.size == 0) {
+         return;
+      }
+      nextOffset += slot.size;
+      slot.pending = true;
+#ifdef __linux__
+      if (activeMethod == IoMethod::URING) {
+         if (!ring.submitRead(fd, slot.buffer.get(), static_cast<unsigned>(requestSize(slot.size)), slot.offset, index)) {
+            slot.pending = false;
+            failed = true;
+            return;
+         }
+         inFlight++;
+         return;
+      }
+#endif
+      {
+         std::lock_guard<std::mutex> lock(mutex);
+         requests.push_back(index);
+      }
+      wake.notify_all();
+   }
+
+   // Ждёт, пока закончится чтение в ячейку index.
+   void complete(size_t index) {
+      Slot& slot = slots[index];
+      if (activeMethod == IoMethod::PREAD) {
+         std::unique_lock<std::mutex> lock(mutex);
+         wake.wait(lock, [&slot] { return !slot.pending; });
+         failed = failed || !slot.readOk;
+         return;
+      }
+#ifdef __linux__
+      while (slot.pending && !failed) {
+         reap();
+      }
+#endif
+   }
+
+   // Фоновый поток pread: читает блоки в порядке запросов.
+   void readLoop() {
+      std::unique_lock<std::mutex> lock(mutex);
+      while (true) {
+         wake.wait(lock, [this] { return stopping || !requests.empty(); });
+         if (stopping) {
+            return;
+         }
+         Slot& slot = slots[requests.front()];
+         requests.pop_front();
+         lock.unlock();
+         bool ok = readAt(slot.buffer.get(), slot.size, slot.offset);
+         lock.lock();
+         slot.readOk = ok;
+         slot.pending = false;
+         wake.notify_all();
+      }
+   }
+
+   void release(const Slot& slot) {
+#if !defined(_WIN32) && defined(POSIX_FADV_DONTNEED)
+      if (dropPages && slot.size > 0) {
+         posix_fadvise(fd, static_cast<off_t>(slot.offset), static_cast<off_t>(slot.size), POSIX_FADV_DONTNEED);
+      }
+#else
+      (void)slot;
+#endif
+   }
+
+#ifdef __linux__
+   void reap() {
+      uint64_t tag;
+      int result;
+      if (!ring.wait(tag, result) || tag >= slots.size()) {
+         failed = true;
+         return;
+      }
+      inFlight--;
+      Slot& slot = slots[tag];
+      slot.pending = false;
+      // -EINVAL: ядро не приняло запрос, блок читается обычным pread.
+      if (result < 0 && result != -EINTR && result != -EAGAIN && result != -EINVAL) {
+         failed = true;
+         return;
+      }
+      // Короткое чтение (или прерванный запрос) дочитываем синхронно. С
+      // O_DIRECT - с границы выравнивания: невыровненное смещение даёт EINVAL.
+      size_t got = result > 0 ? static_cast<size_t>(result) : 0;
+      if (directActive) {
+         got = got / READ_ALIGNMENT * READ_ALIGNMENT;
+      }
+      if (got < slot.size && !readAt(slot.buffer.get() + got, slot.size - got, slot.offset + got)) {
+         failed = true;
+      }
+   }
+
+   IoUring ring;
+#endif
+#ifdef _WIN32
+   HANDLE hFile = INVALID_HANDLE_VALUE;
+#else
+   int fd = -1;
+#endif
+   IoMethod activeMethod = IoMethod::PREAD;
+   std::vector<Slot> slots;
+   // Запросы к потоку чтения (pread); pending и readOk слотов - под mutex.
+   std::thread reader;
+   std::mutex mutex;
+   std::condition_variable wake;
+   std::deque<size_t> requests;
+   bool stopping = false;
+   uint64_t length = 0;
+   uint64_t nextOffset = 0;
+   size_t nextSlot = 0;
+   size_t previousSlot = 0;
+   size_t inFlight = 0;
+   bool returned = false;
+   bool directActive = false;
+   bool dropPages = false;
+   bool failed = false;
+};
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "employee.h"
+
+// Источники записей для пакетного режима Creator: синтетический генератор
+// и разбор CSV со стандартного ввода.
+
+inline uint64_t splitMix64(uint64_t value) {
+   value += 0x9E3779B97F4A7C15ull;
+   value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+   value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+   return value ^ (value >> 31);
+}
+
+// Запись с номером index синтетического набора зависит только от (seed,
+// index), поэтому любой кусок файла можно получить независимо.
+inline employee makeSyntheticEmployee(uint64_t seed, uint64_t index) {
+   static const char* const syllables[] = {
+      "an", "ba", "da", "el", "ka", "li", "ma", "ne", "ol", "ra", "se", "ta", "vi", "yu", "zo", "ir"
+   };
+
+   employee person;
+   std::memset(&person, 0, sizeof(person));
+   uint64_t random = splitMix64(seed ^ splitMix64(index));
+
+   person.num = static_cast<int>(index + 1);
+
+   size_t syllableCount = 2 + (random & 3);
+   random >>= 2;
+   size_t length = 0;
+   for (size_t i = 0; i < syllableCount && length + 2 < sizeof(person.name); i++) {
+      std::memcpy(person.name + length, syllables[random & 15], 2);
+      random >>= 4;
+      length += 2;
+   }
+   person.name[0] = static_cast<char>(person.name[0] - 'a' + 'A');
+
+   // Часы кратны четверти часа, от 0 до 250.
+   person.hours = static_cast<double>(random % 1001) * 0.25;
+   return person;
+}
+
+// Разбирает строки "num,name,hours", читая FILE* крупными блоками.
+class CsvEmployeeReader {
+public:
+   static constexpr size_t BUFFER_SIZE = 1 << 20;
+
+   explicit CsvEmployeeReader(std::FILE* in)
+      : in(in), buffer(BUFFER_SIZE), position(buffer.data()), end(buffer.data()) {}
+
+   // false в конце ввода или на ошибочной строке (см. error()).
+   bool next(employee& person) {
+      while (true) {
+         const char* lineEnd = static_cast<const char*>(std::memchr(position, '\n', end - position));
+         if (lineEnd == nullptr && !refill()) {
+            if (position == end) {
+               return false;
+            }
+            lineEnd = end;
+         }
+         else if (lineEnd == nullptr) {
+            continue;
+         }
+
+         const char* line = position;
+         position = lineEnd == end ? end : lineEnd + 1;
+         lineNumber++;
+
+         const char* last = lineEnd;
+         if (last > line && last[-1] == '\r') {
+            last--;
+         }
+         if (last == line) {
+            continue;
+         }
+         const char* problem = parseLine(line, last, person);
+         if (problem != nullptr) {
+            errorText = std::string(problem) + " on CSV line " + std::to_string(lineNumber);
+            return false;
+         }
+         return true;
+      }
+   }
+
+   const std::string& error() const { return errorText; }
+
+private:
+   bool refill() {
+      if (eof) {
+         return false;
+      }
+      size_t rest = end - position;
+      std::memmove(buffer.data(), position, rest);
+      if (rest == buffer.size()) {
+         buffer.resize(buffer.size() * 2);
+      }
+      size_t got = std::fread(buffer.data() + rest, 1, buffer.size() - rest, in);
+      eof = got == 0;
+      position = buffer.data();
+      end = buffer.data() + rest + got;
+      return !eof;
+   }
+
+   // nullptr, если строка разобрана, иначе описание ошибки. Длинное имя -
+   // ошибка, а не молча обрезанное имя: так разные сотрудники не сливаются
+   // в одно имя.
+   static const char* parseLine(const char* first, const char* last, employee& person) {
+      static const char* const MALFORMED = "malformed line";
+      std::memset(&person, 0, sizeof(person));
+
+      auto numResult = std::from_chars(first, last, person.num);
+      if (numResult.ec != std::errc() || numResult.ptr == last || *numResult.ptr != ',') {
+         return MALFORMED;
+      }
+
+      const char* name = numResult.ptr + 1;
+      const char* comma = static_cast<const char*>(std::memchr(name, ',', last - name));
+      if (comma == nullptr || comma == name) {
+         return MALFORMED;
+      }
+      size_t nameLength = static_cast<size_t>(comma - name);
+      if (nameLength > sizeof(person.name) - 1) {
+         return "name longer than 9 characters";
+      }
+      std::memcpy(person.name, name, nameLength);
+
+      auto hoursResult = std::from_chars(comma + 1, last, person.hours);
+      return hoursResult.ec == std::errc() && hoursResult.ptr == last ? nullptr : MALFORMED;
+   }
+
+   std::FILE* in;
+   std::vector<char> buffer;
+   const char* position;
+   const char* end;
+   unsigned long long lineNumber = 0;
+   bool eof = false;
+   std::string errorText;
+};
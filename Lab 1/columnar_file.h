@@ -0,0 +1,215 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "employee.h"
+
+// Колоночный формат файла сотрудников (версия 1):
+//
+//   ColumnarHeader
+//   блок 0: hours[count] (double), num[count] (int32), name[count][10], выравнивание до 8
+//   блок 1: ...
+//   ColumnarBlockInfo[blockCount] - индекс блоков с min/max по num и hours
+//
+// Колонки одного блока лежат подряд, поэтому агрегат по часам читает только
+// колонку hours, а по индексу блоков можно отбросить блок не читая его.
+
+constexpr char COLUMNAR_MAGIC[4] = { 'E', 'M', 'P', 'C' };
+constexpr uint32_t COLUMNAR_VERSION = 1;
+constexpr uint32_t COLUMNAR_BLOCK_RECORDS = 1 << 16;
+constexpr size_t COLUMNAR_NAME_SIZE = sizeof(employee::name);
+
+struct ColumnarHeader {
+   char magic[4];
+   uint32_t version;
+   uint32_t blockRecords;
+   uint32_t reserved;
+   uint64_t recordCount;
+   uint64_t blockCount;
+   uint64_t indexOffset;
+};
+
+struct ColumnarBlockInfo {
+   uint64_t offset;
+   uint32_t count;
+   int32_t minNum;
+   int32_t maxNum;
+   uint32_t reserved;
+   double minHours;
+   double maxHours;
+};
+
+inline size_t columnarBlockSize(size_t count) {
+   size_t size = count * (sizeof(double) + sizeof(int32_t) + COLUMNAR_NAME_SIZE);
+   return (size + 7) & ~size_t(7);
+}
+
+// Накапливает записи и пишет их блок за блоком.
+class ColumnarWriter {
+public:
+   bool open(const std::string& fileName) {
+      out.open(fileName, std::ios::binary | std::ios::trunc);
+      ColumnarHeader header = {};
+      out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+      offset = sizeof(header);
+      return static_cast<bool>(out);
+   }
+
+   void add(const employee& person) {
+      hours.push_back(person.hours);
+      nums.push_back(person.num);
+      names.insert(names.end(), person.name, person.name + COLUMNAR_NAME_SIZE);
+      if (nums.size() == COLUMNAR_BLOCK_RECORDS) {
+         flushBlock();
+      }
+   }
+
+   bool close() {
+      flushBlock();
+      ColumnarHeader header = {};
+      std::memcpy(header.magic, COLUMNAR_MAGIC, sizeof(header.magic));
+      header.version = COLUMNAR_VERSION;
+      header.blockRecords = COLUMNAR_BLOCK_RECORDS;
+      header.recordCount = recordCount;
+      header.blockCount = index.size();
+      header.indexOffset = offset;
+
+      out.write(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(ColumnarBlockInfo));
+      out.seekp(0);
+      out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+      out.close();
+      return !out.fail();
+   }
+
+private:
+   void flushBlock() {
+      size_t count = nums.size();
+      if (count == 0) {
+         return;
+      }
+      // Байты имени после завершающего нуля обнуляются: в исходной записи
+      // там мог остаться мусор со стека.
+      for (size_t i = 0; i < count; i++) {
+         char* name = &names[i * COLUMNAR_NAME_SIZE];
+         size_t length = std::find(name, name + COLUMNAR_NAME_SIZE, '\0') - name;
+         std::fill(name + length, name + COLUMNAR_NAME_SIZE, '\0');
+      }
+
+      ColumnarBlockInfo info = {};
+      info.offset = offset;
+      info.count = static_cast<uint32_t>(count);
+      auto numRange = std::minmax_element(nums.begin(), nums.end());
+      auto hoursRange = std::minmax_element(hours.begin(), hours.end());
+      info.minNum = *numRange.first;
+      info.maxNum = *numRange.second;
+      info.minHours = *hoursRange.first;
+      info.maxHours = *hoursRange.second;
+      index.push_back(info);
+
+      size_t blockSize = columnarBlockSize(count);
+      size_t padding = blockSize - count * (sizeof(double) + sizeof(int32_t) + COLUMNAR_NAME_SIZE);
+      static const char zeros[8] = {};
+      out.write(reinterpret_cast<const char*>(hours.data()), count * sizeof(double));
+      out.write(reinterpret_cast<const char*>(nums.data()), count * sizeof(int32_t));
+      out.write(names.data(), names.size());
+      out.write(zeros, padding);
+
+      offset += blockSize;
+      recordCount += count;
+      hours.clear();
+      nums.clear();
+      names.clear();
+   }
+
+   std::ofstream out;
+   std::vector<double> hours;
+   std::vector<int32_t> nums;
+   std::vector<char> names;
+   std::vector<ColumnarBlockInfo> index;
+   uint64_t offset = 0;
+   uint64_t recordCount = 0;
+};
+
+// Колоночный файл, уже загруженный или отображённый в память, только для чтения.
+class ColumnarView {
+public:
+   // false, если в data нет правильного колоночного файла.
+   bool attach(const char* data, size_t size) {
+      if (size < sizeof(ColumnarHeader)) {
+         return false;
+      }
+      std::memcpy(&header, data, sizeof(header));
+      if (std::memcmp(header.magic, COLUMNAR_MAGIC, sizeof(header.magic)) != 0
+         || header.version != COLUMNAR_VERSION
+         || header.blockRecords == 0
+         || header.indexOffset > size
+         || (size - header.indexOffset) / sizeof(ColumnarBlockInfo) != header.blockCount
+         || (size - header.indexOffset) % sizeof(ColumnarBlockInfo) != 0) {
+         return false;
+      }
+      base = data;
+      blocks = reinterpret_cast<const ColumnarBlockInfo*>(data + header.indexOffset);
+      // Колонки читаются прямо из отображения, поэтому каждый блок должен
+      // лежать до индекса и быть выровнен; запись ищется как
+      // first / blockRecords, поэтому все блоки, кроме последнего, полные.
+      uint64_t records = 0;
+      for (uint64_t b = 0; b < header.blockCount; b++) {
+         const ColumnarBlockInfo& info = blocks[b];
+         bool last = b + 1 == header.blockCount;
+         if (info.offset < sizeof(ColumnarHeader) || info.offset > header.indexOffset
+            || info.offset % alignof(double) != 0
+            || info.count == 0 || info.count > header.blockRecords
+            || (!last && info.count != header.blockRecords)
+            || columnarBlockSize(info.count) > header.indexOffset - info.offset) {
+            return false;
+         }
+         records += info.count;
+      }
+      return records == header.recordCount;
+   }
+
+   uint64_t recordCount() const { return header.recordCount; }
+   uint64_t blockCount() const { return header.blockCount; }
+   uint32_t blockRecords() const { return header.blockRecords; }
+   const ColumnarBlockInfo& block(size_t i) const { return blocks[i]; }
+
+   const double* hours(size_t i) const {
+      return reinterpret_cast<const double*>(base + blocks[i].offset);
+   }
+   const int32_t* nums(size_t i) const {
+      return reinterpret_cast<const int32_t*>(base + blocks[i].offset + blocks[i].count * sizeof(double));
+   }
+   const char* names(size_t i) const {
+      return base + blocks[i].offset + blocks[i].count * (sizeof(double) + sizeof(int32_t));
+   }
+
+   // Собирает записи [first, first + n) обратно в виде массива структур.
+   void read(uint64_t first, size_t n, employee* out) const {
+      while (n > 0) {
+         size_t blockIndex = static_cast<size_t>(first / header.blockRecords);
+         size_t row = static_cast<size_t>(first % header.blockRecords);
+         size_t take = std::min<size_t>(n, blocks[blockIndex].count - row);
+         const double* blockHours = hours(blockIndex);
+         const int32_t* blockNums = nums(blockIndex);
+         const char* blockNames = names(blockIndex);
+         for (size_t i = 0; i < take; i++) {
+            std::memset(out, 0, sizeof(employee));
+            out->num = blockNums[row + i];
+            std::memcpy(out->name, blockNames + (row + i) * COLUMNAR_NAME_SIZE, COLUMNAR_NAME_SIZE);
+            out->hours = blockHours[row + i];
+            out++;
+         }
+         first += take;
+         n -= take;
+      }
+   }
+
+private:
+   ColumnarHeader header = {};
+   const char* base = nullptr;
+   const ColumnarBlockInfo* blocks = nullptr;
+};
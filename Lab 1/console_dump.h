@@ -0,0 +1,116 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "employee_file.h"
+#include "mapped_file.h"
+#include "report_format.h"
+
+// Быстрый вывод файлов на консоль для Main: файлы отображаются в память,
+// строки собираются в большой буфер и уходят в стандартный вывод крупными
+// блоками вместо setw/getline на каждую запись. --head/--tail N
+// ограничивают вывод первыми и последними N записями (строками отчёта),
+// пропущенное заменяется строкой "...".
+
+constexpr size_t DUMP_BUFFER_SIZE = 1 << 20;
+
+// 0 - без ограничения; если заданы оба, выводятся и начало, и конец.
+struct DumpRange {
+   uint64_t head = 0;
+   uint64_t tail = 0;
+};
+
+// Выводятся элементы [0, headEnd) и [tailBegin, count), промежуток
+// между ними пропускается.
+inline void selectDumpRange(uint64_t count, const DumpRange& range, uint64_t& headEnd, uint64_t& tailBegin) {
+   if (range.head == 0 && range.tail == 0) {
+      headEnd = tailBegin = count;
+      return;
+   }
+   headEnd = std::min(range.head, count);
+   tailBegin = count - std::min(range.tail, count);
+   tailBegin = std::max(tailBegin, headEnd);
+}
+
+// Выводит записи двоичного файла любого формата. false, если файл не
+// открывается.
+inline bool dumpBinFile(const std::string& fileName, const DumpRange& range, OutputFile& out) {
+   EmployeeFile file;
+   if (!file.open(fileName)) {
+      return false;
+   }
+   uint64_t headEnd, tailBegin;
+   selectDumpRange(file.count(), range, headEnd, tailBegin);
+
+   std::vector<char> buffer(DUMP_BUFFER_SIZE);
+   static const char header[] = "\n\tBinary file content:\nEmployee ID    Employee name  Employee hours\n";
+   char* p = std::copy(header, header + sizeof(header) - 1, buffer.data());
+   bool written = true;
+   auto dumpRecords = [&](uint64_t first, uint64_t last) {
+      constexpr size_t BATCH = 256;
+      employee batch[BATCH];
+      for (uint64_t i = first; i < last && written; i += BATCH) {
+         size_t n = static_cast<size_t>(std::min<uint64_t>(BATCH, last - i));
+         file.read(i, n, batch);
+         for (size_t j = 0; j < n; j++) {
+            if (p > buffer.data() + buffer.size() - REPORT_MAX_ROW_SIZE) {
+               written = written && out.write(buffer.data(), p - buffer.data());
+               p = buffer.data();
+            }
+            p = formatListingRow(p, batch[j]);
+         }
+      }
+   };
+
+   dumpRecords(0, headEnd);
+   if (tailBegin > headEnd) {
+      *p++ = '.';
+      *p++ = '.';
+      *p++ = '.';
+      *p++ = '\n';
+   }
+   dumpRecords(tailBegin, file.count());
+   return out.write(buffer.data(), p - buffer.data()) && written;
+}
+
+// Копирует текстовый файл (отчёт) прямо из его отображения.
+inline bool dumpTextFile(const std::string& fileName, const DumpRange& range, OutputFile& out) {
+   MappedFile file;
+   if (!file.open(fileName)) {
+      return false;
+   }
+   const char* data = file.data();
+   size_t size = file.size();
+   if (range.head == 0 && range.tail == 0) {
+      return size == 0 || out.write(data, size);
+   }
+
+   // Конец первых head строк и начало последних tail строк.
+   size_t headEnd = 0;
+   for (uint64_t line = 0; line < range.head && headEnd < size; line++) {
+      const void* newline = std::memchr(data + headEnd, '\n', size - headEnd);
+      headEnd = newline ? static_cast<const char*>(newline) - data + 1 : size;
+   }
+   size_t tailBegin = size;
+   if (range.tail > 0) {
+      size_t position = size > 0 && data[size - 1] == '\n' ? size - 1 : size;
+      uint64_t lines = 0;
+      while (position > 0 && lines < range.tail) {
+         position--;
+         if (data[position] == '\n') {
+            lines++;
+         }
+      }
+      tailBegin = lines == range.tail ? position + 1 : 0;
+   }
+   tailBegin = std::max(tailBegin, headEnd);
+
+   bool written = out.write(data, headEnd);
+   if (tailBegin > headEnd) {
+      written = written && out.write("...\n", 4);
+   }
+   return written && out.write(data + tailBegin, size - tailBegin);
+}
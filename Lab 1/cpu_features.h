@@ -0,0 +1,85 @@
+#pragma once
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define EMPLOYEE_X86 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// Функция, скомпилированная под набор инструкций, который не включён для
+// всей программы; вызывается только после проверки cpuFeatures().
+#if defined(__GNUC__) || defined(__clang__)
+#define EMPLOYEE_TARGET(features) __attribute__((target(features)))
+#else
+#define EMPLOYEE_TARGET(features)
+#endif
+
+// Возможности процессора, которые определяются один раз при старте
+// и используются для выбора реализации вычислительных ядер.
+struct CpuFeatures {
+   bool sse2 = false;
+   bool sse42 = false;
+   bool avx2 = false;
+   bool avx512f = false;
+};
+
+#ifdef EMPLOYEE_X86
+inline void cpuidLeaf(unsigned leaf, unsigned subleaf, unsigned regs[4]) {
+#if defined(_MSC_VER)
+   int info[4];
+   __cpuidex(info, static_cast<int>(leaf), static_cast<int>(subleaf));
+   for (int i = 0; i < 4; i++) {
+      regs[i] = static_cast<unsigned>(info[i]);
+   }
+#else
+   __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+inline unsigned long long readXcr0() {
+#if defined(_MSC_VER)
+   return _xgetbv(0);
+#else
+   unsigned eax, edx;
+   __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+   return (static_cast<unsigned long long>(edx) << 32) | eax;
+#endif
+}
+#endif
+
+inline CpuFeatures detectCpuFeatures() {
+   CpuFeatures features;
+#ifdef EMPLOYEE_X86
+   unsigned regs[4];
+   cpuidLeaf(0, 0, regs);
+   unsigned maxLeaf = regs[0];
+
+   cpuidLeaf(1, 0, regs);
+   features.sse2 = (regs[3] >> 26) & 1;
+   features.sse42 = (regs[2] >> 20) & 1;
+   bool osSavesYmm = false;
+   bool osSavesZmm = false;
+   if ((regs[2] >> 27) & 1) {
+      // Регистры AVX можно использовать, только если ОС сохраняет их при
+      // переключении контекста (XCR0).
+      unsigned long long xcr0 = readXcr0();
+      osSavesYmm = (xcr0 & 0x6) == 0x6;
+      osSavesZmm = (xcr0 & 0xE6) == 0xE6;
+   }
+
+   if (maxLeaf >= 7) {
+      cpuidLeaf(7, 0, regs);
+      features.avx2 = osSavesYmm && ((regs[1] >> 5) & 1);
+      features.avx512f = osSavesZmm && ((regs[1] >> 16) & 1);
+   }
+#endif
+   return features;
+}
+
+inline const CpuFeatures& cpuFeatures() {
+   static const CpuFeatures features = detectCpuFeatures();
+   return features;
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "cpu_features.h"
+
+#ifdef EMPLOYEE_X86
+#include <immintrin.h>
+#endif
+#if defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+// CRC-32C (Castagnoli) для контрольных сумм блоков файла сотрудников.
+// На x86 считается инструкцией crc32 из SSE4.2, на ARMv8 с расширением CRC -
+// инструкциями crc32c*, иначе - по таблицам (slicing-by-8). Все варианты
+// дают одинаковый результат; вариант выбирается по CPUID при старте.
+
+constexpr uint32_t CRC32C_POLYNOMIAL = 0x82F63B78;
+
+// Ядро продолжает вычисление по внутреннему (инвертированному) состоянию.
+using Crc32cKernel = uint32_t (*)(uint32_t state, const char* data, size_t size);
+
+struct Crc32cTables {
+   uint32_t table[8][256];
+};
+
+inline Crc32cTables makeCrc32cTables() {
+   Crc32cTables tables;
+   for (uint32_t i = 0; i < 256; i++) {
+      uint32_t crc = i;
+      for (int bit = 0; bit < 8; bit++) {
+         crc = (crc >> 1) ^ (crc & 1 ? CRC32C_POLYNOMIAL : 0);
+      }
+      tables.table[0][i] = crc;
+   }
+   for (uint32_t i = 0; i < 256; i++) {
+      for (int k = 1; k < 8; k++) {
+         uint32_t previous = tables.table[k - 1][i];
+         tables.table[k][i] = (previous >> 8) ^ tables.table[0][previous & 0xFF];
+      }
+   }
+   return tables;
+}
+
+inline const Crc32cTables& crc32cTables() {
+   static const Crc32cTables tables = makeCrc32cTables();
+   return tables;
+}
+
+inline uint32_t crc32cTable(uint32_t state, const char* data, size_t size) {
+   const uint32_t (*t)[256] = crc32cTables().table;
+   const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+   // Восемь байтов за шаг; порядок байтов в словах - little-endian.
+   for (; size >= 8; p += 8, size -= 8) {
+      uint32_t low = (p[0] | p[1] << 8 | p[2] << 16 | static_cast<uint32_t>(p[3]) << 24) ^ state;
+      uint32_t high = p[4] | p[5] << 8 | p[6] << 16 | static_cast<uint32_t>(p[7]) << 24;
+      state = t[7][low & 0xFF] ^ t[6][(low >> 8) & 0xFF] ^ t[5][(low >> 16) & 0xFF] ^ t[4][low >> 24]
+         ^ t[3][high & 0xFF] ^ t[2][(high >> 8) & 0xFF] ^ t[1][(high >> 16) & 0xFF] ^ t[0][high >> 24];
+   }
+   for (; size > 0; p++, size--) {
+      state = t[0][(state ^ *p) & 0xFF] ^ (state >> 8);
+   }
+   return state;
+}
+
+#ifdef EMPLOYEE_X86
+EMPLOYEE_TARGET("sse4.2")
+inline uint32_t crc32cSse42(uint32_t state, const char* data, size_t size) {
+#if defined(__x86_64__) || defined(_M_X64)
+   uint64_t wide = state;
+   for (; size >= 8; data += 8, size -= 8) {
+      uint64_t word;
+      std::memcpy(&word, data, sizeof(word));
+      wide = _mm_crc32_u64(wide, word);
+   }
+   state = static_cast<uint32_t>(wide);
+#endif
+   for (; size >= 4; data += 4, size -= 4) {
+      uint32_t word;
+      std::memcpy(&word, data, sizeof(word));
+      state = _mm_crc32_u32(state, word);
+   }
+   for (; size > 0; data++, size--) {
+      state = _mm_crc32_u8(state, static_cast<unsigned char>(*data));
+   }
+   return state;
+}
+#endif
+
+#if defined(__ARM_FEATURE_CRC32)
+inline uint32_t crc32cArm(uint32_t state, const char* data, size_t size) {
+   for (; size >= 8; data += 8, size -= 8) {
+      uint64_t word;
+      std::memcpy(&word, data, sizeof(word));
+      state = __crc32cd(state, word);
+   }
+   for (; size > 0; data++, size--) {
+      state = __crc32cb(state, static_cast<unsigned char>(*data));
+   }
+   return state;
+}
+#endif
+
+struct Crc32cKernelInfo {
+   const char* name;
+   Crc32cKernel kernel;
+};
+
+inline Crc32cKernelInfo selectCrc32cKernel(const CpuFeatures& features) {
+#ifdef EMPLOYEE_X86
+   if (features.sse42) return { "sse4.2", crc32cSse42 };
+#else
+   (void)features;
+#endif
+#if defined(__ARM_FEATURE_CRC32)
+   return { "armv8", crc32cArm };
+#endif
+   return { "table", crc32cTable };
+}
+
+inline const Crc32cKernelInfo& crc32cKernel() {
+   static const Crc32cKernelInfo kernel = selectCrc32cKernel(cpuFeatures());
+   return kernel;
+}
+
+// CRC-32C данных; crc - результат для предыдущих байтов потока (0 в начале).
+inline uint32_t crc32c(const char* data, size_t size, uint32_t crc = 0) {
+   return ~crc32cKernel().kernel(~crc, data, size);
+}
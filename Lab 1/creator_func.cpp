@@ -0,0 +1,202 @@
+#include <string>
+#include <iostream>
+#include <vector>
+#include <charconv>
+#include <cstdio>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include "employee_io.h"
+#include "employee.h"
+#include "bulk_input.h"
+#include "employee_file.h"
+#include "employee_checksum.h"
+
+bool parseCreatorArguments(int argc, char* argv[], CreatorOptions& options) {
+	std::vector<std::string> positional;
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "--synthetic" && i + 1 < argc) {
+			options.source = CreatorSource::SYNTHETIC;
+			std::string seed = argv[++i];
+			auto result = std::from_chars(seed.data(), seed.data() + seed.size(), options.seed);
+			if (result.ec != std::errc() || result.ptr != seed.data() + seed.size()) {
+				return false;
+			}
+		}
+		else if (arg == "--csv") {
+			options.source = CreatorSource::CSV;
+		}
+		else if (arg == "--columnar") {
+			options.format = EmployeeFormat::COLUMNAR;
+		}
+		else if (arg == "--archive") {
+			options.format = EmployeeFormat::ARCHIVE;
+		}
+		else if (arg == "--index") {
+			options.index = true;
+		}
+		else if (arg == "--checksum") {
+			options.checksum = true;
+		}
+		else if (arg == "--threads" && i + 1 < argc) {
+			int threads;
+			if (!parseNumber(argv[++i], threads)) {
+				return false;
+			}
+			options.threads = std::max(1, threads);
+		}
+		else {
+			positional.push_back(arg);
+		}
+	}
+	if (positional.size() != 2 || (options.checksum && options.format != EmployeeFormat::LEGACY)) {
+		return false;
+	}
+	options.fileName = positional[0];
+	const std::string& count = positional[1];
+	auto result = std::from_chars(count.data(), count.data() + count.size(), options.count);
+	return result.ec == std::errc() && result.ptr == count.data() + count.size();
+}
+
+int createFromConsole(const CreatorOptions& options) {
+	EmployeeWriter out;
+	if (!out.open(options.fileName, options.format, options.index, options.checksum)) {
+		std::cout << "Error: cannot open file " << options.fileName << " for writing\n";
+		return 1;
+	}
+
+	// Когда записи идут в стандартный вывод (конвейер Main), подсказки
+	// выводятся в поток ошибок, а каждая запись отправляется сразу.
+	bool toPipe = options.fileName == "-";
+	std::ostream& prompt = toPipe ? std::cerr : std::cout;
+
+	bool written = true;
+
+	for (unsigned long long i = 0; i < options.count && written; i++) {
+		employee person;
+
+		prompt << "Person #: " << i + 1 << "\nEnter the employee's identification number:\n";
+		std::cin >> person.num;
+
+		prompt << "Enter the employee's name (maximum 9 letters):\n";
+		std::cin >> person.name;
+
+		prompt << "Enter the number of working hours:\n";
+		std::cin >> person.hours;
+
+		written = out.write(person) && (!toPipe || out.flush());
+	}
+
+	if (!out.close() || !written) {
+		std::cout << "Error: cannot write to file " << options.fileName << "\n";
+		return 1;
+	}
+	return 0;
+}
+
+// Пакетный режим: записи собираются в большие блоки и пишутся на диск
+// одним вызовом на блок. Для CSV count - верхняя граница числа записей.
+int createInBulk(const CreatorOptions& options) {
+	EmployeeWriter out;
+	if (!out.open(options.fileName, options.format, options.index, options.checksum)) {
+		std::cout << "Error: cannot open file " << options.fileName << " for writing\n";
+		return 1;
+	}
+
+	CsvEmployeeReader csv(stdin);
+	bool written = true;
+
+	for (unsigned long long i = 0; i < options.count && written; i++) {
+		employee person;
+		if (options.source == CreatorSource::SYNTHETIC) {
+			person = makeSyntheticEmployee(options.seed, i);
+		}
+		else if (!csv.next(person)) {
+			break;
+		}
+		written = out.write(person);
+	}
+
+	if (!out.close() || !written) {
+		std::cout << "Error: cannot write to file " << options.fileName << "\n";
+		return 1;
+	}
+	if (!csv.error().empty()) {
+		std::cout << "Error: " << csv.error() << "\n";
+		return 1;
+	}
+	return 0;
+}
+
+// Синтетический файл несколькими потоками. Файл делится на куски по
+// CHECKSUM_BLOCK_RECORDS записей; поток берёт следующий свободный кусок,
+// генерирует его (запись зависит только от seed и номера) и пишет по
+// смещению куска, заодно считая его контрольную сумму. Поэтому файл не
+// зависит от числа потоков и порядка, в котором они успели.
+int createInParallel(const CreatorOptions& options) {
+	OutputFile out;
+	uint64_t fileBytes = options.count * sizeof(employee);
+	if (!options.checksum) {
+		std::remove(checksumFileName(options.fileName).c_str());
+	}
+	std::remove(indexFileName(options.fileName).c_str());
+	if (!out.open(options.fileName) || !out.resize(fileBytes)) {
+		std::cout << "Error: cannot open file " << options.fileName << " for writing\n";
+		return 1;
+	}
+
+	uint64_t chunkCount = (options.count + CHECKSUM_BLOCK_RECORDS - 1) / CHECKSUM_BLOCK_RECORDS;
+	std::vector<uint32_t> checksums(options.checksum ? chunkCount : 0);
+	std::atomic<uint64_t> nextChunk(0);
+	std::atomic<bool> written(true);
+	auto generate = [&]() {
+		std::vector<employee> chunk(static_cast<size_t>(std::min<uint64_t>(CHECKSUM_BLOCK_RECORDS, options.count)));
+		for (uint64_t c = nextChunk++; c < chunkCount && written; c = nextChunk++) {
+			uint64_t first = c * CHECKSUM_BLOCK_RECORDS;
+			size_t n = static_cast<size_t>(std::min<uint64_t>(CHECKSUM_BLOCK_RECORDS, options.count - first));
+			for (size_t i = 0; i < n; i++) {
+				chunk[i] = makeSyntheticEmployee(options.seed, first + i);
+			}
+			const char* bytes = reinterpret_cast<const char*>(chunk.data());
+			if (options.checksum) {
+				checksums[c] = crc32c(bytes, n * sizeof(employee));
+			}
+			if (!out.writeAt(bytes, n * sizeof(employee), first * sizeof(employee))) {
+				written = false;
+			}
+		}
+	};
+
+	size_t threads = static_cast<size_t>(std::max<uint64_t>(1, std::min<uint64_t>(options.threads, chunkCount)));
+	std::vector<std::thread> workers;
+	for (size_t t = 1; t < threads; t++) {
+		workers.emplace_back(generate);
+	}
+	generate();
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+	bool closed = out.close();
+
+	if (!written || !closed || (options.checksum && !writeChecksumFile(options.fileName, options.count, checksums))) {
+		std::cout << "Error: cannot write to file " << options.fileName << "\n";
+		return 1;
+	}
+	return 0;
+}
+
+int createEmployees(const CreatorOptions& options) {
+	if (options.source == CreatorSource::CONSOLE) {
+		return createFromConsole(options);
+	}
+	if (options.threads > 1) {
+		if (options.source == CreatorSource::SYNTHETIC && options.format == EmployeeFormat::LEGACY
+			&& options.fileName != "-" && !options.index) {
+			return createInParallel(options);
+		}
+		std::cout << "Warning: --threads applies only to --synthetic files in the original format"
+			" without --index, writing with one thread\n";
+	}
+	return createInBulk(options);
+}
@@ -1,7 +1,18 @@
 #pragma once
 
+#include "../Common/record_schema.h"
+
 struct employee {
    int num;
    char name[10];
    double hours;
-};
\ No newline at end of file
+};
+
+// Колонки - как в листинге Main (setw(15)); упакованная запись занимает
+// 22 байта вместо sizeof(employee) = 24.
+using EmployeeSchema = RecordSchema<employee,
+   Field<&employee::num, 15>,
+   Field<&employee::name, 15>,
+   Field<&employee::hours, 15>>;
+
+static_assert(EmployeeSchema::packedSize == 22, "employee packs into 22 bytes");
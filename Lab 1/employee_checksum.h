@@ -0,0 +1,133 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "employee.h"
+#include "mapped_file.h"
+#include "employee_index.h"
+#include "crc32c.h"
+
+// Контрольные суммы CRC-32C блоков по CHECKSUM_BLOCK_RECORDS записей,
+// которые Creator пишет рядом с файлом данных (<файл>.crc), как и индекс.
+// Сам файл остаётся в исходном формате и читается прежними программами.
+// Последний блок может быть короче. Как и у индекса, в заголовке хранятся
+// размер файла данных и число записей: устаревшие суммы не проверяются.
+
+constexpr char CHECKSUM_MAGIC[4] = { 'E', 'C', 'R', 'C' };
+constexpr uint32_t CHECKSUM_VERSION = 1;
+constexpr uint32_t CHECKSUM_BLOCK_RECORDS = 1 << 16;
+constexpr uint64_t NO_BAD_BLOCK = UINT64_MAX;
+
+struct EmployeeChecksumHeader {
+   char magic[4];
+   uint32_t version;
+   uint32_t blockRecords;
+   uint32_t reserved;
+   uint64_t dataFileSize;
+   uint64_t recordCount;
+   uint64_t blockCount;
+};
+
+inline std::string checksumFileName(const std::string& dataFileName) {
+   return dataFileName + ".crc";
+}
+
+// Записывает контрольные суммы всех блоков файла исходного формата из recordCount записей.
+inline bool writeChecksumFile(const std::string& dataFileName, uint64_t recordCount,
+   const std::vector<uint32_t>& checksums) {
+   EmployeeChecksumHeader header = {};
+   std::memcpy(header.magic, CHECKSUM_MAGIC, sizeof(header.magic));
+   header.version = CHECKSUM_VERSION;
+   header.blockRecords = CHECKSUM_BLOCK_RECORDS;
+   header.dataFileSize = fileSize(dataFileName);
+   header.recordCount = recordCount;
+   header.blockCount = checksums.size();
+
+   OutputFile out;
+   return out.open(checksumFileName(dataFileName))
+      && out.write(reinterpret_cast<const char*>(&header), sizeof(header))
+      && out.write(reinterpret_cast<const char*>(checksums.data()), checksums.size() * sizeof(uint32_t));
+}
+
+// Считает контрольные суммы блоков для потока записей исходного формата,
+// приходящего кусками любого размера.
+class EmployeeChecksumBuilder {
+public:
+   void add(const char* data, size_t size) {
+      constexpr size_t BLOCK_BYTES = size_t(CHECKSUM_BLOCK_RECORDS) * sizeof(employee);
+      while (size > 0) {
+         size_t take = std::min(size, BLOCK_BYTES - blockBytes);
+         current = crc32c(data, take, current);
+         blockBytes += take;
+         data += take;
+         size -= take;
+         if (blockBytes == BLOCK_BYTES) {
+            checksums.push_back(current);
+            current = 0;
+            blockBytes = 0;
+         }
+      }
+   }
+
+   // Суммы всех блоков, включая последний неполный.
+   const std::vector<uint32_t>& finish() {
+      if (blockBytes > 0) {
+         checksums.push_back(current);
+         current = 0;
+         blockBytes = 0;
+      }
+      return checksums;
+   }
+
+   bool write(const std::string& dataFileName, uint64_t recordCount) {
+      return writeChecksumFile(dataFileName, recordCount, finish());
+   }
+
+private:
+   std::vector<uint32_t> checksums;
+   uint32_t current = 0;
+   size_t blockBytes = 0;
+};
+
+class EmployeeChecksums {
+public:
+   bool open(const std::string& dataFileName) {
+      if (!mapping.open(checksumFileName(dataFileName)) || mapping.size() < sizeof(EmployeeChecksumHeader)) {
+         return false;
+      }
+      std::memcpy(&header, mapping.data(), sizeof(header));
+      if (std::memcmp(header.magic, CHECKSUM_MAGIC, sizeof(header.magic)) != 0
+         || header.version != CHECKSUM_VERSION
+         || header.blockRecords != CHECKSUM_BLOCK_RECORDS
+         || (mapping.size() - sizeof(header)) / sizeof(uint32_t) != header.blockCount) {
+         return false;
+      }
+      sums = reinterpret_cast<const uint32_t*>(mapping.data() + sizeof(header));
+      return true;
+   }
+
+   bool isFresh(uint64_t dataFileSize, uint64_t recordCount) const {
+      return header.dataFileSize == dataFileSize && header.recordCount == recordCount
+         && header.blockCount == (recordCount + CHECKSUM_BLOCK_RECORDS - 1) / CHECKSUM_BLOCK_RECORDS;
+   }
+
+   // Проверяет один блок отображённого файла исходного формата из recordCount записей.
+   bool verify(const char* data, uint64_t recordCount, uint64_t block) const {
+      uint64_t first = block * CHECKSUM_BLOCK_RECORDS;
+      uint64_t last = std::min<uint64_t>(recordCount, first + CHECKSUM_BLOCK_RECORDS);
+      return verifyBytes(data + first * sizeof(employee), static_cast<size_t>((last - first) * sizeof(employee)), block);
+   }
+
+   // Проверяет байты одного блока, прочитанного отдельно.
+   bool verifyBytes(const char* data, size_t size, uint64_t block) const {
+      return block < header.blockCount && crc32c(data, size) == sums[block];
+   }
+
+private:
+   MappedFile mapping;
+   EmployeeChecksumHeader header = {};
+   const uint32_t* sums = nullptr;
+};
@@ -0,0 +1,221 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "employee.h"
+#include "mapped_file.h"
+#include "columnar_file.h"
+#include "archive_file.h"
+#include "employee_index.h"
+#include "employee_checksum.h"
+
+enum class EmployeeFormat {
+   LEGACY,
+   COLUMNAR,
+   ARCHIVE
+};
+
+// Диапазон записей одного блока и границы num в нём.
+struct EmployeeBlock {
+   uint64_t first;
+   uint64_t count;
+   int minNum;
+   int maxNum;
+};
+
+// Файл сотрудников в любом из форматов: исходном (массив employee),
+// колоночном или сжатом архиве. Формат определяется по заголовку.
+class EmployeeFile {
+public:
+   bool open(const std::string& fileName) {
+      if (!mapping.open(fileName)) {
+         return false;
+      }
+      if (view.attach(mapping.data(), mapping.size())) {
+         fileFormat = EmployeeFormat::COLUMNAR;
+      }
+      else if (archive.attach(mapping.data(), mapping.size())) {
+         fileFormat = EmployeeFormat::ARCHIVE;
+      }
+      else {
+         fileFormat = EmployeeFormat::LEGACY;
+      }
+      return true;
+   }
+
+   void close() {
+      mapping.close();
+      fileFormat = EmployeeFormat::LEGACY;
+   }
+
+   EmployeeFormat format() const { return fileFormat; }
+   bool isColumnar() const { return fileFormat == EmployeeFormat::COLUMNAR; }
+   bool isArchive() const { return fileFormat == EmployeeFormat::ARCHIVE; }
+   const ColumnarView& columns() const { return view; }
+   const ArchiveView& archived() const { return archive; }
+   // Сырые байты файла; в исходном формате это и есть записи.
+   const char* data() const { return mapping.data(); }
+
+   uint64_t count() const {
+      switch (fileFormat) {
+      case EmployeeFormat::COLUMNAR: return view.recordCount();
+      case EmployeeFormat::ARCHIVE: return archive.recordCount();
+      default: return mapping.size() / sizeof(employee);
+      }
+   }
+
+   // Копирует записи [first, first + n) в out. false, если попался
+   // повреждённый блок архива (см. isDamaged()).
+   bool read(uint64_t first, size_t n, employee* out) const {
+      switch (fileFormat) {
+      case EmployeeFormat::COLUMNAR:
+         view.read(first, n, out);
+         return true;
+      case EmployeeFormat::ARCHIVE:
+         return archive.read(first, n, out);
+      default:
+         std::memcpy(out, mapping.data() + first * sizeof(employee), n * sizeof(employee));
+         return true;
+      }
+   }
+
+   // Часть уже прочитанных записей взята из повреждённого блока.
+   bool isDamaged() const { return fileFormat == EmployeeFormat::ARCHIVE && archive.isDamaged(); }
+
+   // Блоки с известными границами num; файл исходного формата - один блок
+   // без границ.
+   size_t blockCount() const {
+      switch (fileFormat) {
+      case EmployeeFormat::COLUMNAR: return static_cast<size_t>(view.blockCount());
+      case EmployeeFormat::ARCHIVE: return static_cast<size_t>(archive.blockCount());
+      default: return 1;
+      }
+   }
+
+   EmployeeBlock block(size_t i) const {
+      switch (fileFormat) {
+      case EmployeeFormat::COLUMNAR:
+         return { i * uint64_t(view.blockRecords()), view.block(i).count, view.block(i).minNum, view.block(i).maxNum };
+      case EmployeeFormat::ARCHIVE:
+         return { i * uint64_t(archive.blockRecords()), archive.block(i).count, archive.block(i).minNum, archive.block(i).maxNum };
+      default:
+         return { 0, count(), INT_MIN, INT_MAX };
+      }
+   }
+
+private:
+   MappedFile mapping;
+   ColumnarView view;
+   ArchiveView archive;
+   EmployeeFormat fileFormat = EmployeeFormat::LEGACY;
+};
+
+// Пишет записи в любом формате, собирая их в крупные блоки записи.
+// С withIndex при close() рядом с файлом пишется индекс по num, с
+// withChecksums - контрольные суммы блоков (только исходный формат).
+// Имя файла "-" означает стандартный вывод (только исходный формат).
+class EmployeeWriter {
+public:
+   static constexpr size_t BATCH_RECORDS = 1 << 16;
+
+   bool open(const std::string& dataFileName, EmployeeFormat fileFormat, bool withIndex = false,
+      bool withChecksums = false) {
+      fileName = dataFileName;
+      format = fileFormat;
+      buildIndex = withIndex;
+      buildChecksums = withChecksums;
+      if (buildChecksums && format != EmployeeFormat::LEGACY) {
+         return false;
+      }
+      if (fileName == "-") {
+         if (format != EmployeeFormat::LEGACY || buildIndex || buildChecksums) {
+            return false;
+         }
+         batch.reserve(BATCH_RECORDS);
+         legacyOut.openStandardOutput();
+         return true;
+      }
+      // Суммы и индекс от прежнего содержимого файла считались бы свежими,
+      // если совпадут размер и число записей.
+      if (!buildChecksums) {
+         std::remove(checksumFileName(fileName).c_str());
+      }
+      if (!buildIndex) {
+         std::remove(indexFileName(fileName).c_str());
+      }
+      switch (format) {
+      case EmployeeFormat::COLUMNAR: return columnarOut.open(fileName);
+      case EmployeeFormat::ARCHIVE: return archiveOut.open(fileName);
+      default:
+         batch.reserve(BATCH_RECORDS);
+         return legacyOut.open(fileName);
+      }
+   }
+
+   bool write(const employee& person) {
+      if (buildIndex) {
+         index.add(person.num, recordCount);
+      }
+      recordCount++;
+      switch (format) {
+      case EmployeeFormat::COLUMNAR:
+         columnarOut.add(person);
+         return true;
+      case EmployeeFormat::ARCHIVE:
+         archiveOut.add(person);
+         return true;
+      default:
+         batch.push_back(person);
+         return batch.size() < BATCH_RECORDS || flush();
+      }
+   }
+
+   bool close() {
+      bool ok;
+      switch (format) {
+      case EmployeeFormat::COLUMNAR:
+         ok = columnarOut.close();
+         break;
+      case EmployeeFormat::ARCHIVE:
+         ok = archiveOut.close();
+         break;
+      default:
+         ok = flush();
+         ok = legacyOut.close() && ok;
+      }
+      return ok && (!buildIndex || index.write(fileName, recordCount))
+         && (!buildChecksums || checksums.write(fileName, recordCount));
+   }
+
+   // Сразу отдаёт накопленные записи ОС (только исходный формат: блоки
+   // колоночного формата и архива пишутся целиком).
+   bool flush() {
+      if (format != EmployeeFormat::LEGACY) {
+         return true;
+      }
+      const char* bytes = reinterpret_cast<const char*>(batch.data());
+      if (buildChecksums) {
+         checksums.add(bytes, batch.size() * sizeof(employee));
+      }
+      bool ok = legacyOut.write(bytes, batch.size() * sizeof(employee));
+      batch.clear();
+      return ok;
+   }
+
+private:
+   std::string fileName;
+   EmployeeFormat format = EmployeeFormat::LEGACY;
+   bool buildIndex = false;
+   bool buildChecksums = false;
+   uint64_t recordCount = 0;
+   EmployeeIndexBuilder index;
+   EmployeeChecksumBuilder checksums;
+   OutputFile legacyOut;
+   ColumnarWriter columnarOut;
+   ArchiveWriter archiveOut;
+   std::vector<employee> batch;
+};
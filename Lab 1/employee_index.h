@@ -0,0 +1,111 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "mapped_file.h"
+
+// Индекс num -> запись, который Creator пишет рядом с файлом данных
+// (<файл>.idx). Записи индекса отсортированы по (num, record), поэтому
+// поиск сотрудника - двоичный поиск вместо просмотра всего файла.
+// record - порядковый номер записи в файле данных; для исходного формата
+// смещение в байтах равно record * sizeof(employee).
+// В заголовке хранится размер файла данных и число записей: если файл
+// изменился после построения индекса, индекс считается устаревшим.
+
+constexpr char INDEX_MAGIC[4] = { 'E', 'I', 'D', 'X' };
+constexpr uint32_t INDEX_VERSION = 1;
+
+struct EmployeeIndexHeader {
+   char magic[4];
+   uint32_t version;
+   uint64_t dataFileSize;
+   uint64_t recordCount;
+   uint64_t entryCount;
+};
+
+struct EmployeeIndexEntry {
+   int32_t num;
+   uint32_t reserved;
+   uint64_t record;
+};
+
+inline std::string indexFileName(const std::string& dataFileName) {
+   return dataFileName + ".idx";
+}
+
+inline uint64_t fileSize(const std::string& fileName) {
+   std::ifstream in(fileName, std::ios::binary | std::ios::ate);
+   return in ? static_cast<uint64_t>(in.tellg()) : 0;
+}
+
+inline bool operator<(const EmployeeIndexEntry& a, const EmployeeIndexEntry& b) {
+   return a.num != b.num ? a.num < b.num : a.record < b.record;
+}
+
+// Собирает пары (num, номер записи), пока пишется файл данных.
+class EmployeeIndexBuilder {
+public:
+   void add(int num, uint64_t record) {
+      entries.push_back({ num, 0, record });
+   }
+
+   bool write(const std::string& dataFileName, uint64_t recordCount) {
+      std::sort(entries.begin(), entries.end());
+
+      EmployeeIndexHeader header = {};
+      std::memcpy(header.magic, INDEX_MAGIC, sizeof(header.magic));
+      header.version = INDEX_VERSION;
+      header.dataFileSize = fileSize(dataFileName);
+      header.recordCount = recordCount;
+      header.entryCount = entries.size();
+
+      OutputFile out;
+      return out.open(indexFileName(dataFileName))
+         && out.write(reinterpret_cast<const char*>(&header), sizeof(header))
+         && out.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(EmployeeIndexEntry));
+   }
+
+private:
+   std::vector<EmployeeIndexEntry> entries;
+};
+
+class EmployeeIndex {
+public:
+   bool open(const std::string& dataFileName) {
+      if (!mapping.open(indexFileName(dataFileName)) || mapping.size() < sizeof(EmployeeIndexHeader)) {
+         return false;
+      }
+      std::memcpy(&header, mapping.data(), sizeof(header));
+      if (std::memcmp(header.magic, INDEX_MAGIC, sizeof(header.magic)) != 0
+         || header.version != INDEX_VERSION
+         || (mapping.size() - sizeof(header)) / sizeof(EmployeeIndexEntry) != header.entryCount) {
+         return false;
+      }
+      entries = reinterpret_cast<const EmployeeIndexEntry*>(mapping.data() + sizeof(header));
+      return true;
+   }
+
+   bool isFresh(uint64_t dataFileSize, uint64_t recordCount) const {
+      return header.dataFileSize == dataFileSize && header.recordCount == recordCount;
+   }
+
+   // Номера записей с данным num в порядке файла.
+   std::vector<uint64_t> find(int num) const {
+      const EmployeeIndexEntry* end = entries + header.entryCount;
+      const EmployeeIndexEntry* it = std::lower_bound(entries, end, EmployeeIndexEntry{ num, 0, 0 });
+      std::vector<uint64_t> records;
+      for (; it != end && it->num == num; ++it) {
+         records.push_back(it->record);
+      }
+      return records;
+   }
+
+private:
+   MappedFile mapping;
+   EmployeeIndexHeader header = {};
+   const EmployeeIndexEntry* entries = nullptr;
+};
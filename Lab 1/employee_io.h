@@ -0,0 +1,85 @@
+#pragma once
+
+#include <charconv>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "external_sort.h"
+#include "employee_file.h"
+#include "report_format.h"
+#include "block_reader.h"
+#include "rate_table.h"
+
+// employee_io: Creator и Reporter в виде библиотеки. Утилиты Creator.exe
+// и Reporter.exe - тонкие обёртки над этими функциями, а Main вызывает
+// их прямо в своём процессе, без CreateProcess и лишних проходов по файлу.
+
+constexpr size_t DEFAULT_SORT_MEMORY = 64 << 20;
+
+// Число целиком, без лишних знаков после него. В отличие от std::stoi не
+// бросает исключений: неверный аргумент - просто false.
+template <class T>
+bool parseNumber(const std::string& text, T& value) {
+   auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+   return result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+enum class CreatorSource {
+   CONSOLE,
+   SYNTHETIC,
+   CSV
+};
+
+struct CreatorOptions {
+   std::string fileName;
+   unsigned long long count = 0;
+   CreatorSource source = CreatorSource::CONSOLE;
+   uint64_t seed = 0;
+   EmployeeFormat format = EmployeeFormat::LEGACY;
+   bool index = false;
+   bool checksum = false;
+   // Потоки генерации (--threads): синтетические файлы исходного формата без индекса.
+   size_t threads = 1;
+};
+
+struct ReporterOptions {
+   std::string binFileName;
+   // Остальные входные файлы: их строки идут после строк binFileName, а с
+   // mergeByNum все файлы сливаются по num.
+   std::vector<std::string> extraBinFileNames;
+   bool mergeByNum = false;
+   std::string reportFileName;
+   double xPerHour = 0.0;
+   // Ставки сотрудников (--rates); по xPerHour платят тем, кого нет в
+   // файле. generateReport загружает таблицу в rates.
+   std::string rateFileName;
+   std::shared_ptr<const RateTable> rates;
+   // Зарплаты и итоги в точных целых копейках (--exact, см. money.h).
+   bool exactMoney = false;
+   bool useMapping = false;
+   bool printStats = false;
+   bool summary = false;
+   size_t topCount = 0;
+   bool incremental = false;
+   // Дописывать в отчёт новые записи файла, пока его не удалят (--follow).
+   bool follow = false;
+   size_t threads = 1;
+   SortKey sortKey = SortKey::NONE;
+   size_t sortMemory = DEFAULT_SORT_MEMORY;
+   std::string lookupList;
+   std::string label;
+   ReportFormat format = ReportFormat::TEXT;
+   IoMethod ioMethod = IoMethod::DEFAULT;
+   bool directIo = false;
+};
+
+bool parseCreatorArguments(int argc, char* argv[], CreatorOptions& options);
+bool parseReporterArguments(int argc, char* argv[], ReporterOptions& options);
+
+// 0 при успехе, 1 при ошибке (сообщение выводится в консоль).
+int createEmployees(const CreatorOptions& options);
+
+// Число записей в отчёте или -1 при ошибке.
+// При пустом label в заголовке стоят имена двоичных файлов.
+long long generateReport(const ReporterOptions& options);
@@ -0,0 +1,304 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <queue>
+#include <string>
+#include <vector>
+#include "employee.h"
+#include "employee_file.h"
+#include "rate_table.h"
+
+// Сортировка файла employee произвольного размера: файл режется на
+// отсортированные в памяти серии, серии сбрасываются во временные файлы
+// и сливаются k-путевым слиянием через кучу. Весь расход памяти
+// ограничен memoryBudget.
+
+enum class SortKey {
+   NONE,
+   NUM,
+   NAME,
+   SALARY
+};
+
+constexpr size_t MIN_RUN_BUFFER_RECORDS = 4096;
+
+inline bool parseSortKey(const std::string& text, SortKey& key) {
+   if (text == "num") key = SortKey::NUM;
+   else if (text == "name") key = SortKey::NAME;
+   else if (text == "salary") key = SortKey::SALARY;
+   else return false;
+   return true;
+}
+
+// Разбирает размеры вида "4096", "64K", "256M", "2G".
+inline bool parseMemorySize(const std::string& text, size_t& bytes) {
+   unsigned long long value = 0;
+   auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+   size_t end = static_cast<size_t>(result.ptr - text.data());
+   if (result.ec != std::errc() || end + 1 < text.size()) {
+      return false;
+   }
+   int shift = 0;
+   if (end < text.size()) {
+      switch (text[end]) {
+      case 'K': case 'k': shift = 10; break;
+      case 'M': case 'm': shift = 20; break;
+      case 'G': case 'g': shift = 30; break;
+      default: return false;
+      }
+   }
+   if (value > std::numeric_limits<size_t>::max() >> shift) {
+      return false;
+   }
+   bytes = static_cast<size_t>(value << shift);
+   return true;
+}
+
+// Байты после завершающего нуля никогда не выводятся; если их обнулить,
+// имена можно сравнивать простым memcmp.
+inline void normalizeName(employee& person) {
+   const void* terminator = std::memchr(person.name, '\0', sizeof(person.name));
+   if (terminator != nullptr) {
+      char* tail = static_cast<char*>(const_cast<void*>(terminator));
+      std::memset(tail, 0, person.name + sizeof(person.name) - tail);
+   }
+}
+
+struct EmployeeLess {
+   SortKey key;
+   double xPerHour;
+   const RateTable* rates = nullptr;
+
+   bool operator()(const employee& a, const employee& b) const {
+      switch (key) {
+      case SortKey::NAME:
+         return std::memcmp(a.name, b.name, sizeof(a.name)) < 0;
+      case SortKey::SALARY:
+         return salary(a) < salary(b);
+      default:
+         return a.num < b.num;
+      }
+   }
+
+   double salary(const employee& person) const {
+      return person.hours * (rates != nullptr ? rates->rate(person.num, xPerHour) : xPerHour);
+   }
+};
+
+class RunReader {
+public:
+   RunReader(const std::string& fileName, size_t bufferRecords)
+      : in(fileName, std::ios::binary), buffer(std::max<size_t>(bufferRecords, 1)) {}
+
+   bool isOpen() const { return static_cast<bool>(in); }
+   bool error() const { return failed; }
+
+   // false в конце серии или при ошибке чтения (см. error()).
+   bool next(employee& person) {
+      if (position == filled) {
+         in.read(reinterpret_cast<char*>(buffer.data()), buffer.size() * sizeof(employee));
+         size_t got = static_cast<size_t>(in.gcount());
+         // Серия пишется целыми записями: обрывок записи - тоже ошибка.
+         failed = in.bad() || (!in && !in.eof()) || got % sizeof(employee) != 0;
+         filled = failed ? 0 : got / sizeof(employee);
+         position = 0;
+         if (filled == 0) {
+            return false;
+         }
+      }
+      person = buffer[position++];
+      return true;
+   }
+
+private:
+   std::ifstream in;
+   std::vector<employee> buffer;
+   size_t position = 0;
+   size_t filled = 0;
+   bool failed = false;
+};
+
+class RunWriter {
+public:
+   RunWriter(const std::string& fileName, size_t bufferRecords)
+      : out(fileName, std::ios::binary) {
+      buffer.reserve(std::max<size_t>(bufferRecords, 1));
+   }
+
+   bool isOpen() const { return static_cast<bool>(out); }
+
+   void operator()(const employee& person) {
+      buffer.push_back(person);
+      if (buffer.size() == buffer.capacity()) {
+         flush();
+      }
+   }
+
+   bool flush() {
+      out.write(reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(employee));
+      buffer.clear();
+      return static_cast<bool>(out);
+   }
+
+private:
+   std::ofstream out;
+   std::vector<employee> buffer;
+};
+
+// Устойчивое k-путевое слияние отсортированных серий: равные ключи идут в порядке серий.
+template <class Sink>
+bool mergeRuns(const std::vector<std::string>& runs, size_t bufferRecords, const EmployeeLess& less,
+   Sink& sink) {
+   struct Head {
+      employee person;
+      size_t run;
+   };
+   auto after = [&less](const Head& a, const Head& b) {
+      if (less(b.person, a.person)) return true;
+      if (less(a.person, b.person)) return false;
+      return a.run > b.run;
+   };
+
+   std::vector<std::unique_ptr<RunReader>> readers;
+   std::priority_queue<Head, std::vector<Head>, decltype(after)> heap(after);
+   for (size_t i = 0; i < runs.size(); i++) {
+      readers.push_back(std::make_unique<RunReader>(runs[i], bufferRecords));
+      if (!readers.back()->isOpen()) {
+         std::cout << "Error: cannot open temporary file " << runs[i] << "\n";
+         return false;
+      }
+      Head head{ {}, i };
+      if (readers[i]->next(head.person)) {
+         heap.push(head);
+      }
+   }
+
+   while (!heap.empty()) {
+      Head head = heap.top();
+      heap.pop();
+      sink(head.person);
+      if (readers[head.run]->next(head.person)) {
+         heap.push(head);
+      }
+      else if (readers[head.run]->error()) {
+         std::cout << "Error: cannot read temporary file " << runs[head.run] << "\n";
+         return false;
+      }
+   }
+   return true;
+}
+
+inline void removeRuns(const std::vector<std::string>& runs) {
+   for (const std::string& run : runs) {
+      std::remove(run.c_str());
+   }
+}
+
+// Передаёт все записи файла в sink в порядке, заданном less.
+// Временные серии создаются как tempPrefix + ".runN" и затем удаляются.
+// Возвращает число записей или -1 при ошибке.
+template <class Sink>
+long long externalSort(const EmployeeFile& file, const std::string& tempPrefix,
+   const EmployeeLess& less, size_t memoryBudget, Sink& sink) {
+   size_t budgetRecords = std::max(memoryBudget / sizeof(employee), MIN_RUN_BUFFER_RECORDS);
+   // stable_sort заняла бы ещё буфер размером с серию. Вместо неё std::sort
+   // упорядочивает номера записей (равные ключи - по номеру, то есть
+   // устойчиво), и записи переставляются на месте по циклам перестановки.
+   size_t runRecords = std::max<size_t>(std::min<uint64_t>(memoryBudget / (sizeof(employee) + sizeof(uint32_t)),
+      UINT32_MAX), MIN_RUN_BUFFER_RECORDS);
+   uint64_t count = file.count();
+   std::vector<employee> run(static_cast<size_t>(std::min<uint64_t>(runRecords, count)));
+   std::vector<uint32_t> order(run.size());
+   std::vector<std::string> runs;
+
+   for (uint64_t first = 0; first < count; first += run.size()) {
+      size_t filled = static_cast<size_t>(std::min<uint64_t>(run.size(), count - first));
+      file.read(first, filled, run.data());
+      for (size_t i = 0; i < filled; i++) {
+         normalizeName(run[i]);
+         order[i] = static_cast<uint32_t>(i);
+      }
+      std::sort(order.begin(), order.begin() + filled, [&](uint32_t a, uint32_t b) {
+         if (less(run[a], run[b])) return true;
+         if (less(run[b], run[a])) return false;
+         return a < b;
+      });
+      // На место i встаёт запись order[i]; поставленные отмечаются order[i] = i.
+      for (size_t i = 0; i < filled; i++) {
+         if (order[i] == i) {
+            continue;
+         }
+         employee saved = run[i];
+         size_t j = i;
+         while (order[j] != i) {
+            size_t next = order[j];
+            run[j] = run[next];
+            order[j] = static_cast<uint32_t>(j);
+            j = next;
+         }
+         run[j] = saved;
+         order[j] = static_cast<uint32_t>(j);
+      }
+
+      // Всё поместилось в одну серию - временные файлы не нужны.
+      if (runs.empty() && filled == count) {
+         for (size_t i = 0; i < filled; i++) {
+            sink(run[i]);
+         }
+         return static_cast<long long>(count);
+      }
+
+      std::string runName = tempPrefix + ".run" + std::to_string(runs.size());
+      std::ofstream out(runName, std::ios::binary);
+      out.write(reinterpret_cast<const char*>(run.data()), filled * sizeof(employee));
+      runs.push_back(runName);
+      if (!out) {
+         std::cout << "Error: cannot write temporary file " << runName << "\n";
+         removeRuns(runs);
+         return -1;
+      }
+   }
+   std::vector<employee>().swap(run);
+   std::vector<uint32_t>().swap(order);
+
+   // Каждой серии при слиянии нужен свой буфер чтения; если серий слишком
+   // много, сначала сливаем их группами в более длинные серии.
+   size_t maxFanIn = std::max<size_t>(2, budgetRecords / MIN_RUN_BUFFER_RECORDS - 1);
+   size_t bufferRecords = budgetRecords / (maxFanIn + 1);
+   size_t nextRun = runs.size();
+   while (runs.size() > maxFanIn) {
+      std::vector<std::string> level;
+      for (size_t first = 0; first < runs.size(); first += maxFanIn) {
+         size_t last = std::min(runs.size(), first + maxFanIn);
+         if (last - first == 1) {
+            level.push_back(runs[first]);
+            continue;
+         }
+         std::vector<std::string> group(runs.begin() + first, runs.begin() + last);
+         std::string merged = tempPrefix + ".run" + std::to_string(nextRun++);
+         RunWriter writer(merged, bufferRecords);
+         bool ok = writer.isOpen() && mergeRuns(group, bufferRecords, less, writer) && writer.flush();
+         removeRuns(group);
+         level.push_back(merged);
+         if (!ok) {
+            std::cout << "Error: cannot write temporary file " << merged << "\n";
+            removeRuns(level);
+            removeRuns(std::vector<std::string>(runs.begin() + last, runs.end()));
+            return -1;
+         }
+      }
+      runs.swap(level);
+   }
+
+   bool ok = mergeRuns(runs, budgetRecords / (runs.size() + 1), less, sink);
+   removeRuns(runs);
+   return ok ? static_cast<long long>(count) : -1;
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include "process.h"
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#endif
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+
+// Ожидание дописывания в файл (Reporter --follow). В Linux файл
+// отслеживается через inotify: запись, закрытие, удаление и
+// переименование будят ожидающего сразу. Ожидание всё равно ограничено
+// таймаутом - на случай файловых систем, где inotify молчит (сетевые).
+// В других системах и если inotify недоступен файл просто опрашивается,
+// а удаление замечается по пропаже пути.
+
+// Наибольшая задержка строки при inotify и период опроса без него.
+constexpr int WATCH_TIMEOUT_MS = 1000;
+constexpr int WATCH_POLL_INTERVAL_MS = 100;
+
+enum class WatchEvent {
+   CHANGED,
+   TIMEOUT,
+   // Файл удалён или переименован: дописываний больше не будет.
+   GONE,
+   FAILED
+};
+
+inline NativeHandle openForReading(const std::string& fileName) {
+#ifdef _WIN32
+   HANDLE handle = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+      NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+   return handle;
+#else
+   return ::open(fileName.c_str(), O_RDONLY | O_CLOEXEC);
+#endif
+}
+
+// Текущий размер открытого файла; false, если его не узнать.
+inline bool handleSize(NativeHandle file, uint64_t& size) {
+#ifdef _WIN32
+   LARGE_INTEGER length;
+   if (!GetFileSizeEx(file, &length)) {
+      return false;
+   }
+   size = static_cast<uint64_t>(length.QuadPart);
+#else
+   struct stat status;
+   if (fstat(file, &status) != 0) {
+      return false;
+   }
+   size = static_cast<uint64_t>(status.st_size);
+#endif
+   return true;
+}
+
+class FileWatcher {
+public:
+   FileWatcher() = default;
+   FileWatcher(const FileWatcher&) = delete;
+   FileWatcher& operator=(const FileWatcher&) = delete;
+   ~FileWatcher() { close(); }
+
+   // false, если следить за файлом нельзя; тогда wait() просто ждёт
+   // WATCH_POLL_INTERVAL_MS и проверяет, не удалён ли файл.
+   bool open(const std::string& fileName, NativeHandle file) {
+      close();
+      watchedName = fileName;
+      watchedFile = file;
+#ifdef __linux__
+      fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+      if (fd >= 0 && inotify_add_watch(fd, fileName.c_str(),
+         IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB | IN_MOVE_SELF | IN_DELETE_SELF) >= 0) {
+         return true;
+      }
+      close();
+#endif
+      return false;
+   }
+
+   void close() {
+#ifdef __linux__
+      if (fd >= 0) {
+         ::close(fd);
+      }
+      fd = -1;
+#endif
+   }
+
+   WatchEvent wait() {
+#ifdef __linux__
+      if (fd >= 0) {
+         pollfd request = { fd, POLLIN, 0 };
+         int ready = poll(&request, 1, WATCH_TIMEOUT_MS);
+         if (ready < 0) {
+            return errno == EINTR ? WatchEvent::TIMEOUT : WatchEvent::FAILED;
+         }
+         if (ready == 0) {
+            return isGone() ? WatchEvent::GONE : WatchEvent::TIMEOUT;
+         }
+         // Накопившиеся события разбираются разом.
+         alignas(inotify_event) char events[4096];
+         bool gone = false;
+         ssize_t got;
+         while ((got = read(fd, events, sizeof(events))) > 0) {
+            for (ssize_t offset = 0; offset < got;) {
+               const inotify_event* event = reinterpret_cast<const inotify_event*>(events + offset);
+               gone = gone || (event->mask & (IN_MOVE_SELF | IN_DELETE_SELF | IN_IGNORED)) != 0;
+               offset += sizeof(inotify_event) + event->len;
+            }
+         }
+         return gone || isGone() ? WatchEvent::GONE : WatchEvent::CHANGED;
+      }
+#endif
+      std::this_thread::sleep_for(std::chrono::milliseconds(WATCH_POLL_INTERVAL_MS));
+      return isGone() ? WatchEvent::GONE : WatchEvent::TIMEOUT;
+   }
+
+private:
+   // Файла больше нет под прежним именем: он удалён, переименован или
+   // заменён другим. Удаление открытого файла inotify сообщает только как
+   // IN_ATTRIB (число ссылок), поэтому проверяется и оно.
+   bool isGone() const {
+#ifdef _WIN32
+      return GetFileAttributesA(watchedName.c_str()) == INVALID_FILE_ATTRIBUTES &&
+         (GetLastError() == ERROR_FILE_NOT_FOUND || GetLastError() == ERROR_PATH_NOT_FOUND);
+#else
+      struct stat opened;
+      if (fstat(watchedFile, &opened) != 0) {
+         return false;
+      }
+      if (opened.st_nlink == 0) {
+         return true;
+      }
+      struct stat named;
+      if (stat(watchedName.c_str(), &named) != 0) {
+         return errno == ENOENT || errno == ENOTDIR;
+      }
+      return named.st_dev != opened.st_dev || named.st_ino != opened.st_ino;
+#endif
+   }
+
+#ifdef __linux__
+   int fd = -1;
+#endif
+   std::string watchedName;
+   NativeHandle watchedFile = NO_HANDLE;
+};
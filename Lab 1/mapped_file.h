@@ -0,0 +1,303 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <climits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+// Весь файл, отображённый в память только для чтения.
+class MappedFile {
+public:
+   MappedFile() = default;
+   MappedFile(const MappedFile&) = delete;
+   MappedFile& operator=(const MappedFile&) = delete;
+   ~MappedFile() { close(); }
+
+   bool open(const std::string& fileName) {
+      close();
+#ifdef _WIN32
+      hFile = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+         NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+      if (hFile == INVALID_HANDLE_VALUE) {
+         return false;
+      }
+      LARGE_INTEGER fileSize;
+      if (!GetFileSizeEx(hFile, &fileSize)) {
+         close();
+         return false;
+      }
+      length = static_cast<size_t>(fileSize.QuadPart);
+      if (length == 0) {
+         return true;
+      }
+      hMapping = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+      if (hMapping == NULL) {
+         close();
+         return false;
+      }
+      view = static_cast<const char*>(MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0));
+      if (view == nullptr) {
+         close();
+         return false;
+      }
+#else
+      fd = ::open(fileName.c_str(), O_RDONLY);
+      if (fd < 0) {
+         return false;
+      }
+      struct stat st;
+      if (fstat(fd, &st) != 0) {
+         close();
+         return false;
+      }
+      length = static_cast<size_t>(st.st_size);
+      if (length == 0) {
+         return true;
+      }
+      void* address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (address == MAP_FAILED) {
+         close();
+         return false;
+      }
+      madvise(address, length, MADV_SEQUENTIAL);
+      view = static_cast<const char*>(address);
+#endif
+      return true;
+   }
+
+   void close() {
+#ifdef _WIN32
+      if (view != nullptr) {
+         UnmapViewOfFile(view);
+      }
+      if (hMapping != NULL) {
+         CloseHandle(hMapping);
+      }
+      if (hFile != INVALID_HANDLE_VALUE) {
+         CloseHandle(hFile);
+      }
+      hMapping = NULL;
+      hFile = INVALID_HANDLE_VALUE;
+#else
+      if (view != nullptr) {
+         munmap(const_cast<char*>(view), length);
+      }
+      if (fd >= 0) {
+         ::close(fd);
+      }
+      fd = -1;
+#endif
+      view = nullptr;
+      length = 0;
+   }
+
+   const char* data() const { return view; }
+   size_t size() const { return length; }
+
+private:
+#ifdef _WIN32
+   HANDLE hFile = INVALID_HANDLE_VALUE;
+   HANDLE hMapping = NULL;
+#else
+   int fd = -1;
+#endif
+   const char* view = nullptr;
+   size_t length = 0;
+};
+
+// Выходной файл без буфера: каждый write() сразу уходит в ОС, поэтому
+// вызывающий должен передавать крупные блоки.
+class OutputFile {
+public:
+   OutputFile() = default;
+   OutputFile(const OutputFile&) = delete;
+   OutputFile& operator=(const OutputFile&) = delete;
+   ~OutputFile() { close(); }
+
+   bool open(const std::string& fileName) {
+      close();
+      owned = true;
+#ifdef _WIN32
+      hFile = CreateFileA(fileName.c_str(), GENERIC_WRITE, FILE_SHARE_READ,
+         NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+      return hFile != INVALID_HANDLE_VALUE;
+#else
+      fd = ::open(fileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+      return fd >= 0;
+#endif
+   }
+
+   // Открывает (или создаёт) файл, не усекая его; запись идёт в конец.
+   bool openForAppend(const std::string& fileName) {
+      close();
+      owned = true;
+#ifdef _WIN32
+      hFile = CreateFileA(fileName.c_str(), FILE_APPEND_DATA, FILE_SHARE_READ,
+         NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+      return hFile != INVALID_HANDLE_VALUE;
+#else
+      fd = ::open(fileName.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+      return fd >= 0;
+#endif
+   }
+
+   // Запись в стандартный вывод процесса; close() его не закрывает.
+   void openStandardOutput() {
+      close();
+      owned = false;
+#ifdef _WIN32
+      hFile = GetStdHandle(STD_OUTPUT_HANDLE);
+#else
+      fd = STDOUT_FILENO;
+#endif
+   }
+
+   bool write(const char* data, size_t size) {
+      while (size > 0) {
+#ifdef _WIN32
+         DWORD chunk = size > 0x40000000 ? 0x40000000 : static_cast<DWORD>(size);
+         DWORD written = 0;
+         if (!WriteFile(hFile, data, chunk, &written, NULL)) {
+            return false;
+         }
+#else
+         ssize_t written = ::write(fd, data, size);
+         if (written < 0) {
+            if (errno == EINTR) {
+               continue;
+            }
+            return false;
+         }
+#endif
+         data += written;
+         size -= static_cast<size_t>(written);
+      }
+      return true;
+   }
+
+   // Задаёт размер файла; после этого части файла можно писать через
+   // writeAt в любом порядке.
+   bool resize(uint64_t size) {
+#ifdef _WIN32
+      LARGE_INTEGER position;
+      position.QuadPart = static_cast<LONGLONG>(size);
+      return SetFilePointerEx(hFile, position, NULL, FILE_BEGIN) && SetEndOfFile(hFile);
+#else
+      return ::ftruncate(fd, static_cast<off_t>(size)) == 0;
+#endif
+   }
+
+   // Пишет по заданному смещению, не сдвигая позицию файла, так что
+   // несколько потоков могут писать свои части одновременно (pwrite в Linux).
+   bool writeAt(const char* data, size_t size, uint64_t offset) {
+      while (size > 0) {
+#ifdef _WIN32
+         DWORD chunk = size > 0x40000000 ? 0x40000000 : static_cast<DWORD>(size);
+         DWORD written = 0;
+         OVERLAPPED position = {};
+         position.Offset = static_cast<DWORD>(offset);
+         position.OffsetHigh = static_cast<DWORD>(offset >> 32);
+         if (!WriteFile(hFile, data, chunk, &written, &position)) {
+            return false;
+         }
+#else
+         ssize_t written = ::pwrite(fd, data, size, static_cast<off_t>(offset));
+         if (written < 0) {
+            if (errno == EINTR) {
+               continue;
+            }
+            return false;
+         }
+#endif
+         data += written;
+         size -= static_cast<size_t>(written);
+         offset += static_cast<uint64_t>(written);
+      }
+      return true;
+   }
+
+   // Пишет буферы один за другим за как можно меньшее число системных
+   // вызовов (writev в Linux).
+   bool writeGather(const std::vector<std::string>& buffers) {
+#ifdef _WIN32
+      for (const std::string& buffer : buffers) {
+         if (!write(buffer.data(), buffer.size())) {
+            return false;
+         }
+      }
+      return true;
+#else
+      std::vector<iovec> pieces;
+      for (const std::string& buffer : buffers) {
+         if (!buffer.empty()) {
+            pieces.push_back({ const_cast<char*>(buffer.data()), buffer.size() });
+         }
+      }
+      size_t next = 0;
+      while (next < pieces.size()) {
+         int count = static_cast<int>(std::min<size_t>(pieces.size() - next, IOV_MAX));
+         ssize_t written = ::writev(fd, &pieces[next], count);
+         if (written < 0) {
+            if (errno == EINTR) {
+               continue;
+            }
+            return false;
+         }
+         // Частичная запись: пропускаем записанные куски и сдвигаем начало
+         // первого недописанного.
+         size_t done = static_cast<size_t>(written);
+         while (next < pieces.size() && done >= pieces[next].iov_len) {
+            done -= pieces[next].iov_len;
+            next++;
+         }
+         if (done > 0) {
+            pieces[next].iov_base = static_cast<char*>(pieces[next].iov_base) + done;
+            pieces[next].iov_len -= done;
+         }
+      }
+      return true;
+#endif
+   }
+
+   // false, если система сообщила об ошибке при закрытии (например,
+   // отложенная запись на сетевом диске не удалась).
+   bool close() {
+      bool ok = true;
+#ifdef _WIN32
+      if (hFile != INVALID_HANDLE_VALUE && owned) {
+         ok = CloseHandle(hFile) != 0;
+      }
+      hFile = INVALID_HANDLE_VALUE;
+#else
+      if (fd >= 0 && owned) {
+         ok = ::close(fd) == 0;
+      }
+      fd = -1;
+#endif
+      return ok;
+   }
+
+private:
+#ifdef _WIN32
+   HANDLE hFile = INVALID_HANDLE_VALUE;
+#else
+   int fd = -1;
+#endif
+   bool owned = true;
+};
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Точный расчёт зарплаты в целых копейках (Reporter --exact). Ставка
+// округляется до копеек, часы - до миллионных; произведение округляется до
+// копеек один раз, половиной от нуля. Суммы копеек складываются без ошибок
+// округления. Диапазон: |часы| и |ставка| до 10^7, NaN и бесконечность
+// вне диапазона - такая зарплата даёт MONEY_INVALID, и отчёт не выдаётся.
+// Копейки печатаются целочисленно, по две цифры за шаг, без ветвлений на
+// каждую цифру.
+
+constexpr int64_t MONEY_SCALE = 100;
+constexpr int64_t HOURS_SCALE = 1000000;
+constexpr double MONEY_LIMIT = 1e7;
+constexpr int64_t MONEY_INVALID = INT64_MIN;
+
+// Сумма для строки отчёта: обычный double или точное число копеек.
+struct Money {
+   Money(double value) : value(value) {}
+
+   static Money fromCents(int64_t cents) {
+      Money money(static_cast<double>(cents) / MONEY_SCALE);
+      money.cents = cents;
+      money.exact = true;
+      return money;
+   }
+
+   double value;
+   int64_t cents = 0;
+   bool exact = false;
+};
+
+// Ложно и для NaN.
+inline bool isMoneyInRange(double value) {
+   return std::fabs(value) <= MONEY_LIMIT;
+}
+
+inline int64_t toHundredths(double value) {
+   if (!isMoneyInRange(value)) {
+      return MONEY_INVALID;
+   }
+   return static_cast<int64_t>(value * MONEY_SCALE + std::copysign(0.5, value));
+}
+
+// Часы делятся на целые и миллионные доли, чтобы произведение на ставку
+// в копейках (до 10^9) не переполняло int64.
+inline int64_t salaryCents(double hours, int64_t rateCents) {
+   if (rateCents == MONEY_INVALID || !isMoneyInRange(hours)) {
+      return MONEY_INVALID;
+   }
+   uint64_t scaled = static_cast<uint64_t>(std::fabs(hours) * HOURS_SCALE + 0.5);
+   uint64_t rate = static_cast<uint64_t>(rateCents < 0 ? -rateCents : rateCents);
+   uint64_t whole = scaled / HOURS_SCALE;
+   uint64_t fraction = scaled % HOURS_SCALE;
+   int64_t cents = static_cast<int64_t>(whole * rate + (fraction * rate + HOURS_SCALE / 2) / HOURS_SCALE);
+   return (hours < 0) != (rateCents < 0) ? -cents : cents;
+}
+
+constexpr char DECIMAL_PAIRS[] =
+   "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+   "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+   "8081828384858687888990919293949596979899";
+
+// Число десятичных цифр value (у 0 - одна).
+inline int decimalDigits(uint64_t value) {
+   static const uint64_t powers[] = {
+      1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull,
+      1000000000ull, 10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull,
+      100000000000000ull, 1000000000000000ull, 10000000000000000ull, 100000000000000000ull,
+      1000000000000000000ull, 10000000000000000000ull
+   };
+   value |= 1;
+#if defined(__GNUC__) || defined(__clang__)
+   int bits = 64 - __builtin_clzll(value);
+#elif defined(_MSC_VER) && defined(_M_X64)
+   unsigned long index;
+   _BitScanReverse64(&index, value);
+   int bits = static_cast<int>(index) + 1;
+#else
+   int bits = 0;
+   for (uint64_t rest = value; rest != 0; rest >>= 1) {
+      bits++;
+   }
+#endif
+   // bits * log10(2) даёт число цифр с точностью до одной.
+   int digits = (bits * 1233) >> 12;
+   return digits + (value >= powers[digits]);
+}
+
+// Пишет копейки как "[-]рубли.кк" и возвращает позицию после них.
+inline char* formatCents(char* p, int64_t cents) {
+   uint64_t magnitude = cents < 0 ? 0 - static_cast<uint64_t>(cents) : static_cast<uint64_t>(cents);
+   *p = '-';
+   p += cents < 0;
+   uint64_t whole = magnitude / MONEY_SCALE;
+   unsigned fraction = static_cast<unsigned>(magnitude % MONEY_SCALE);
+
+   char* end = p + decimalDigits(whole);
+   char* q = end;
+   while (whole >= 100) {
+      q -= 2;
+      std::memcpy(q, DECIMAL_PAIRS + (whole % 100) * 2, 2);
+      whole /= 100;
+   }
+   // Остались одна или две старшие цифры.
+   if (whole >= 10) {
+      std::memcpy(q - 2, DECIMAL_PAIRS + whole * 2, 2);
+   }
+   else {
+      q[-1] = static_cast<char>('0' + whole);
+   }
+   end[0] = '.';
+   std::memcpy(end + 1, DECIMAL_PAIRS + fraction * 2, 2);
+   return end + 3;
+}
+
+inline std::string centsString(int64_t cents) {
+   char text[24];
+   return std::string(text, formatCents(text, cents));
+}
+
+// Зарплата с двумя знаками: из копеек, если она точная, иначе через to_chars.
+inline char* putMoney(char* p, char* limit, const Money& money) {
+   return money.exact ? formatCents(p, money.cents)
+      : std::to_chars(p, limit, money.value, std::chars_format::fixed, 2).ptr;
+}
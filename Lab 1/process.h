@@ -0,0 +1,223 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+#endif
+
+// Запуск дочерних процессов и каналы между ними: CreateProcess/CreatePipe
+// в Windows, posix_spawn/pipe в Linux.
+
+#ifdef _WIN32
+using NativeHandle = HANDLE;
+const NativeHandle NO_HANDLE = INVALID_HANDLE_VALUE;
+const char* const EXECUTABLE_PREFIX = "";
+const char* const EXECUTABLE_SUFFIX = ".exe";
+#else
+using NativeHandle = int;
+const NativeHandle NO_HANDLE = -1;
+const char* const EXECUTABLE_PREFIX = "./";
+const char* const EXECUTABLE_SUFFIX = "";
+#endif
+
+inline std::string executableName(const std::string& program) {
+   return EXECUTABLE_PREFIX + program + EXECUTABLE_SUFFIX;
+}
+
+struct Pipe {
+   NativeHandle readEnd = NO_HANDLE;
+   NativeHandle writeEnd = NO_HANDLE;
+};
+
+struct ChildProcess {
+#ifdef _WIN32
+   HANDLE process = NULL;
+#else
+   pid_t pid = -1;
+#endif
+};
+
+inline void closeHandle(NativeHandle& handle) {
+   if (handle != NO_HANDLE) {
+#ifdef _WIN32
+      CloseHandle(handle);
+#else
+      close(handle);
+#endif
+   }
+   handle = NO_HANDLE;
+}
+
+// Оба конца создаются ненаследуемыми; startProcess() передаёт дочернему
+// процессу только те концы, что ему даны.
+inline bool createPipe(Pipe& pipe) {
+#ifdef _WIN32
+   return CreatePipe(&pipe.readEnd, &pipe.writeEnd, NULL, 0) != 0;
+#else
+   int fds[2];
+   if (::pipe(fds) != 0) {
+      return false;
+   }
+   fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+   fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+   pipe.readEnd = fds[0];
+   pipe.writeEnd = fds[1];
+   return true;
+#endif
+}
+
+// Запускает args[0] с заданными аргументами. stdinHandle/stdoutHandle,
+// если они не NO_HANDLE, заменяют стандартные потоки дочернего процесса.
+inline bool startProcess(const std::vector<std::string>& args, ChildProcess& child,
+   NativeHandle stdinHandle = NO_HANDLE, NativeHandle stdoutHandle = NO_HANDLE) {
+#ifdef _WIN32
+   std::wstring commandLine;
+   for (const std::string& arg : args) {
+      if (!commandLine.empty()) {
+         commandLine += L' ';
+      }
+      bool quote = arg.empty() || arg.find(' ') != std::string::npos;
+      if (quote) commandLine += L'"';
+      commandLine += std::wstring(arg.begin(), arg.end());
+      if (quote) commandLine += L'"';
+   }
+
+   STARTUPINFOW si;
+   ZeroMemory(&si, sizeof(si));
+   si.cb = sizeof(si);
+   bool redirect = stdinHandle != NO_HANDLE || stdoutHandle != NO_HANDLE;
+   if (redirect) {
+      si.dwFlags = STARTF_USESTDHANDLES;
+      si.hStdInput = stdinHandle != NO_HANDLE ? stdinHandle : GetStdHandle(STD_INPUT_HANDLE);
+      si.hStdOutput = stdoutHandle != NO_HANDLE ? stdoutHandle : GetStdHandle(STD_OUTPUT_HANDLE);
+      si.hStdError = GetStdHandle(STD_ERROR_HANDLE);
+      SetHandleInformation(si.hStdInput, HANDLE_FLAG_INHERIT, HANDLE_FLAG_INHERIT);
+      SetHandleInformation(si.hStdOutput, HANDLE_FLAG_INHERIT, HANDLE_FLAG_INHERIT);
+   }
+
+   PROCESS_INFORMATION pi;
+   BOOL started = CreateProcessW(NULL, &commandLine[0], NULL, NULL,
+      redirect ? TRUE : FALSE, 0, NULL, NULL, &si, &pi);
+   if (stdinHandle != NO_HANDLE) {
+      SetHandleInformation(stdinHandle, HANDLE_FLAG_INHERIT, 0);
+   }
+   if (stdoutHandle != NO_HANDLE) {
+      SetHandleInformation(stdoutHandle, HANDLE_FLAG_INHERIT, 0);
+   }
+   if (!started) {
+      return false;
+   }
+   CloseHandle(pi.hThread);
+   child.process = pi.hProcess;
+   return true;
+#else
+   std::vector<char*> argv;
+   for (const std::string& arg : args) {
+      argv.push_back(const_cast<char*>(arg.c_str()));
+   }
+   argv.push_back(nullptr);
+
+   posix_spawn_file_actions_t actions;
+   posix_spawn_file_actions_init(&actions);
+   if (stdinHandle != NO_HANDLE) {
+      posix_spawn_file_actions_adddup2(&actions, stdinHandle, STDIN_FILENO);
+   }
+   if (stdoutHandle != NO_HANDLE) {
+      posix_spawn_file_actions_adddup2(&actions, stdoutHandle, STDOUT_FILENO);
+   }
+   int result = posix_spawn(&child.pid, argv[0], &actions, nullptr, argv.data(), environ);
+   posix_spawn_file_actions_destroy(&actions);
+   return result == 0;
+#endif
+}
+
+// Ждёт дочерний процесс и возвращает его код выхода (-1, если он завершился аварийно).
+inline int waitProcess(ChildProcess& child) {
+#ifdef _WIN32
+   WaitForSingleObject(child.process, INFINITE);
+   DWORD exitCode = 0;
+   GetExitCodeProcess(child.process, &exitCode);
+   CloseHandle(child.process);
+   child.process = NULL;
+   return static_cast<int>(exitCode);
+#else
+   int status = 0;
+   while (waitpid(child.pid, &status, 0) < 0 && errno == EINTR) {
+   }
+   child.pid = -1;
+   return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+#endif
+}
+
+// Читает то, что уже доступно (ждёт хотя бы одного байта).
+// Возвращает число байт, 0 в конце потока, -1 при ошибке.
+inline long long readSome(NativeHandle handle, char* buffer, size_t size) {
+#ifdef _WIN32
+   DWORD got = 0;
+   DWORD chunk = size > 0x40000000 ? 0x40000000 : static_cast<DWORD>(size);
+   if (!ReadFile(handle, buffer, chunk, &got, NULL)) {
+      return GetLastError() == ERROR_BROKEN_PIPE ? 0 : -1;
+   }
+   return got;
+#else
+   while (true) {
+      ssize_t got = ::read(handle, buffer, size);
+      if (got >= 0 || errno != EINTR) {
+         return got;
+      }
+   }
+#endif
+}
+
+inline bool writeAll(NativeHandle handle, const char* data, size_t size) {
+   while (size > 0) {
+#ifdef _WIN32
+      DWORD written = 0;
+      DWORD chunk = size > 0x40000000 ? 0x40000000 : static_cast<DWORD>(size);
+      if (!WriteFile(handle, data, chunk, &written, NULL)) {
+         return false;
+      }
+#else
+      ssize_t written = ::write(handle, data, size);
+      if (written < 0) {
+         if (errno == EINTR) {
+            continue;
+         }
+         return false;
+      }
+#endif
+      data += written;
+      size -= static_cast<size_t>(written);
+   }
+   return true;
+}
+
+inline NativeHandle standardInput() {
+#ifdef _WIN32
+   return GetStdHandle(STD_INPUT_HANDLE);
+#else
+   return STDIN_FILENO;
+#endif
+}
+
+inline NativeHandle standardOutput() {
+#ifdef _WIN32
+   return GetStdHandle(STD_OUTPUT_HANDLE);
+#else
+   return STDOUT_FILENO;
+#endif
+}
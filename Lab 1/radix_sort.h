@@ -0,0 +1,165 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include "employee.h"
+#include "employee_file.h"
+#include "external_sort.h"
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Сортировка по имени поразрядная (LSD) по байтам поля name, младший
+// байт первым. Записи не перемещаются: сортируются 16-байтовые ключи
+// (имя и номер записи), затем записи выдаются по номерам. Каждый проход
+// устойчив, поэтому равные имена остаются в порядке файла, как у
+// externalSort. Проход, в котором у всех ключей один и тот же байт
+// (например, нули после коротких имён), пропускается. Гистограммы и
+// раскладка по корзинам считаются потоками по своим частям массива.
+
+constexpr size_t NAME_KEY_BYTES = sizeof(employee::name);
+// Меньшие части потоку не отдаются: не окупается запуск потока.
+constexpr size_t RADIX_MIN_RECORDS_PER_THREAD = 1 << 14;
+
+constexpr size_t RADIX_PREFETCH_DISTANCE = 16;
+
+inline void prefetchRecord(const char* record) {
+#if defined(__GNUC__) || defined(__clang__)
+   __builtin_prefetch(record);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+   _mm_prefetch(record, _MM_HINT_T0);
+#else
+   (void)record;
+#endif
+}
+
+struct NameKey {
+   uint64_t high;    // name[0..7], старший байт - name[0]
+   uint32_t low;     // name[8..9]
+   uint32_t record;
+};
+
+static_assert(NAME_KEY_BYTES == 10, "NameKey packs a 10-byte name");
+
+inline NameKey makeNameKey(const employee& person, uint32_t record) {
+   NameKey key = { 0, 0, record };
+   for (size_t i = 0; i < 8; i++) {
+      key.high = key.high << 8 | static_cast<unsigned char>(person.name[i]);
+   }
+   key.low = static_cast<unsigned char>(person.name[8]) << 8 | static_cast<unsigned char>(person.name[9]);
+   return key;
+}
+
+// Байт ключа для прохода pass; проход 0 - последний байт имени.
+inline unsigned nameKeyByte(const NameKey& key, size_t pass) {
+   return pass < 2 ? (key.low >> (8 * pass)) & 0xFF : (key.high >> (8 * (pass - 2))) & 0xFF;
+}
+
+// Поразрядной сортировке нужны два массива ключей; номера записей 32-битные.
+// Записи архива по одной не читаются: каждое чтение распаковывало бы целый
+// блок.
+inline bool fitsRadixSort(const EmployeeFile& file, size_t memoryBudget) {
+   uint64_t count = file.count();
+   return !file.isArchive() && count <= UINT32_MAX && count * 2 * sizeof(NameKey) <= memoryBudget;
+}
+
+// Передаёт все записи файла в sink по возрастанию имени (устойчиво).
+// Вызывающий сначала проверяет fitsRadixSort. Возвращает число записей.
+template <class Sink>
+long long radixSortByName(const EmployeeFile& file, size_t threads, Sink& sink) {
+   size_t count = static_cast<size_t>(file.count());
+   threads = std::max<size_t>(1, std::min(threads, count / RADIX_MIN_RECORDS_PER_THREAD));
+   std::vector<NameKey> keys(count), buffer(count);
+
+   // Ключи и полные гистограммы всех проходов строятся за одно чтение файла.
+   using Histograms = std::vector<size_t>;
+   std::vector<Histograms> counts(threads, Histograms(NAME_KEY_BYTES * 256));
+   auto parallel = [threads, count](auto work) {
+      std::vector<std::thread> workers;
+      for (size_t t = 1; t < threads; t++) {
+         workers.emplace_back(work, t, count * t / threads, count * (t + 1) / threads);
+      }
+      work(size_t(0), size_t(0), count / threads);
+      for (std::thread& worker : workers) {
+         worker.join();
+      }
+   };
+   parallel([&](size_t t, size_t first, size_t last) {
+      constexpr size_t BATCH = 4096;
+      employee batch[BATCH];
+      size_t* histograms = counts[t].data();
+      for (size_t i = first; i < last; i += BATCH) {
+         size_t n = std::min(BATCH, last - i);
+         file.read(i, n, batch);
+         for (size_t j = 0; j < n; j++) {
+            normalizeName(batch[j]);
+            NameKey key = makeNameKey(batch[j], static_cast<uint32_t>(i + j));
+            keys[i + j] = key;
+            for (size_t pass = 0; pass < NAME_KEY_BYTES; pass++) {
+               histograms[pass * 256 + nameKeyByte(key, pass)]++;
+            }
+         }
+      }
+   });
+
+   bool firstPass = true;
+   for (size_t pass = 0; pass < NAME_KEY_BYTES; pass++) {
+      size_t total[256] = {};
+      for (size_t t = 0; t < threads; t++) {
+         for (size_t b = 0; b < 256; b++) {
+            total[b] += counts[t][pass * 256 + b];
+         }
+      }
+      if (std::count(total, total + 256, size_t(0)) >= 255) {
+         continue;
+      }
+
+      // Гистограммы частей от первого прохода годятся только для него:
+      // после раскладки в частях лежат другие ключи.
+      if (!firstPass && threads > 1) {
+         parallel([&](size_t t, size_t first, size_t last) {
+            size_t* histogram = counts[t].data() + pass * 256;
+            std::fill(histogram, histogram + 256, 0);
+            for (size_t i = first; i < last; i++) {
+               histogram[nameKeyByte(keys[i], pass)]++;
+            }
+         });
+      }
+      firstPass = false;
+
+      // Начало каждой корзины для каждой части: корзины по порядку, внутри
+      // корзины - части по порядку, что и даёт устойчивость.
+      std::vector<Histograms> offsets(threads, Histograms(256));
+      size_t position = 0;
+      for (size_t b = 0; b < 256; b++) {
+         for (size_t t = 0; t < threads; t++) {
+            offsets[t][b] = position;
+            position += counts[t][pass * 256 + b];
+         }
+      }
+      parallel([&](size_t t, size_t first, size_t last) {
+         size_t* next = offsets[t].data();
+         for (size_t i = first; i < last; i++) {
+            buffer[next[nameKeyByte(keys[i], pass)]++] = keys[i];
+         }
+      });
+      keys.swap(buffer);
+   }
+   std::vector<NameKey>().swap(buffer);
+
+   // Записи берутся вразброс; в исходном формате следующие подгружаются заранее.
+   const char* records = file.format() == EmployeeFormat::LEGACY ? file.data() : nullptr;
+   for (size_t i = 0; i < count; i++) {
+      if (records != nullptr && i + RADIX_PREFETCH_DISTANCE < count) {
+         prefetchRecord(records + size_t(keys[i + RADIX_PREFETCH_DISTANCE].record) * sizeof(employee));
+      }
+      employee person;
+      file.read(keys[i].record, 1, &person);
+      normalizeName(person);
+      sink(person);
+   }
+   return static_cast<long long>(count);
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "mapped_file.h"
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Таблица ставок num -> оплата за час (Reporter --rates). Файл ставок -
+// строки "num,rate" (или через пробел/табуляцию), пустые строки и строки
+// с '#' в начале пропускаются; при повторе num действует последняя строка.
+// Ставки хранятся в хеш-таблице с открытой адресацией (линейное
+// зондирование, заполнение не больше половины), поэтому поиск при
+// формировании отчёта - обычно одно обращение к памяти. Сотрудники без
+// ставки в таблице получают общую ставку из командной строки.
+
+class RateTable {
+public:
+   // false на ошибочной строке или если файл не прочитать (см. error()).
+   bool load(const std::string& fileName) {
+      MappedFile file;
+      if (!file.open(fileName)) {
+         errorText = "cannot open file " + fileName + " for reading";
+         return false;
+      }
+      const char* position = file.data();
+      const char* end = position + file.size();
+      reserve(static_cast<size_t>(std::count(position, end, '\n')) + 1);
+      size_t lineNumber = 0;
+      while (position < end) {
+         const char* lineEnd = static_cast<const char*>(std::memchr(position, '\n', end - position));
+         if (lineEnd == nullptr) {
+            lineEnd = end;
+         }
+         const char* line = position;
+         position = lineEnd == end ? end : lineEnd + 1;
+         lineNumber++;
+
+         const char* last = lineEnd;
+         if (last > line && last[-1] == '\r') {
+            last--;
+         }
+         if (last == line || *line == '#') {
+            continue;
+         }
+         int num = 0;
+         double rate = 0.0;
+         auto numResult = std::from_chars(line, last, num);
+         const char* rateBegin = numResult.ptr;
+         while (rateBegin < last && (*rateBegin == ',' || *rateBegin == ' ' || *rateBegin == '\t')) {
+            rateBegin++;
+         }
+         auto rateResult = std::from_chars(rateBegin, last, rate);
+         if (numResult.ec != std::errc() || rateBegin == numResult.ptr
+            || rateResult.ec != std::errc() || rateResult.ptr != last) {
+            errorText = "malformed rate at line " + std::to_string(lineNumber) + " of file " + fileName;
+            return false;
+         }
+         insert(num, rate);
+      }
+      return true;
+   }
+
+   // Готовит таблицу под count записей, чтобы загрузка обошлась без перехеширования.
+   void reserve(size_t count) {
+      while (count * 2 > slots.size()) {
+         grow();
+      }
+   }
+
+   void insert(int num, double rate) {
+      if ((entries + 1) * 2 > slots.size()) {
+         grow();
+      }
+      Slot& slot = slots[find(num)];
+      if (!slot.used) {
+         slot.num = num;
+         slot.used = 1;
+         entries++;
+      }
+      slot.rate = rate;
+   }
+
+   // Ставка сотрудника или defaultRate, если в таблице её нет.
+   double rate(int num, double defaultRate) const {
+      if (entries == 0) {
+         return defaultRate;
+      }
+      const Slot& slot = slots[find(num)];
+      return slot.used ? slot.rate : defaultRate;
+   }
+
+   // Начинает загрузку ячейки num в кэш; пачка поисков, заранее
+   // подгруженных так, не ждёт каждый промах по очереди.
+   void prefetch(int num) const {
+      if (entries > 0) {
+#if defined(__GNUC__) || defined(__clang__)
+         __builtin_prefetch(&slots[home(num)]);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+         _mm_prefetch(reinterpret_cast<const char*>(&slots[home(num)]), _MM_HINT_T0);
+#endif
+      }
+   }
+
+   size_t size() const { return entries; }
+   const std::string& error() const { return errorText; }
+
+private:
+   struct Slot {
+      int32_t num;
+      uint32_t used;
+      double rate;
+   };
+
+   // Мультипликативное хеширование (Фибоначчи): старшие биты произведения.
+   size_t home(int num) const {
+      return static_cast<size_t>((static_cast<uint32_t>(num) * 0x9E3779B9u) >> (32 - bits));
+   }
+
+   size_t find(int num) const {
+      size_t mask = slots.size() - 1;
+      size_t i = home(num);
+      while (slots[i].used && slots[i].num != num) {
+         i = (i + 1) & mask;
+      }
+      return i;
+   }
+
+   void grow() {
+      std::vector<Slot> old;
+      old.swap(slots);
+      bits = old.empty() ? 4 : bits + 1;
+      slots.assign(size_t(1) << bits, Slot{ 0, 0, 0.0 });
+      for (const Slot& slot : old) {
+         if (slot.used) {
+            slots[find(slot.num)] = slot;
+         }
+      }
+   }
+
+   std::vector<Slot> slots;
+   unsigned bits = 0;
+   size_t entries = 0;
+   std::string errorText;
+};
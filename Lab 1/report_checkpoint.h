@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include "mapped_file.h"
+
+// Контрольная точка инкрементального отчёта (<отчёт>.ckpt): сколько байт
+// файла данных уже попало в отчёт, размер отчёта и накопленные итоги
+// (с --exact сумма зарплат ещё и в целых копейках).
+// Файл данных только дописывается, поэтому при следующем запуске
+// форматируются лишь новые записи. Хэши заголовка и последней обработанной
+// записи позволяют заметить, что файл или параметры отчёта поменялись
+// (в том числе режим --exact), и тогда отчёт строится заново.
+
+constexpr char CHECKPOINT_MAGIC[4] = { 'E', 'C', 'K', 'P' };
+constexpr uint32_t CHECKPOINT_VERSION = 2;
+
+struct ReportCheckpoint {
+   char magic[4];
+   uint32_t version;
+   uint64_t dataOffset;
+   uint64_t recordCount;
+   uint64_t reportSize;
+   uint64_t headerHash;
+   uint64_t tailHash;
+   double xPerHour;
+   double totalHours;
+   double totalSalary;
+   int64_t totalCents;
+   uint32_t exactMoney;
+   uint32_t reserved;
+};
+
+inline std::string checkpointFileName(const std::string& reportFileName) {
+   return reportFileName + ".ckpt";
+}
+
+// FNV-1a, 64 бита.
+inline uint64_t hashBytes(const char* data, size_t size) {
+   uint64_t hash = 14695981039346656037ull;
+   for (size_t i = 0; i < size; i++) {
+      hash ^= static_cast<unsigned char>(data[i]);
+      hash *= 1099511628211ull;
+   }
+   return hash;
+}
+
+inline bool readCheckpoint(const std::string& reportFileName, ReportCheckpoint& checkpoint) {
+   std::ifstream in(checkpointFileName(reportFileName), std::ios::binary);
+   return in.read(reinterpret_cast<char*>(&checkpoint), sizeof(checkpoint))
+      && std::memcmp(checkpoint.magic, CHECKPOINT_MAGIC, sizeof(checkpoint.magic)) == 0
+      && checkpoint.version == CHECKPOINT_VERSION;
+}
+
+// Новая контрольная точка пишется рядом со старой и затем переименовывается
+// поверх неё, так что прерванный запуск оставляет либо старое, либо новое
+// состояние.
+inline bool writeCheckpoint(const std::string& reportFileName, ReportCheckpoint checkpoint) {
+   std::memcpy(checkpoint.magic, CHECKPOINT_MAGIC, sizeof(checkpoint.magic));
+   checkpoint.version = CHECKPOINT_VERSION;
+
+   std::string fileName = checkpointFileName(reportFileName);
+   std::string tempName = fileName + ".tmp";
+   {
+      OutputFile out;
+      if (!out.open(tempName) || !out.write(reinterpret_cast<const char*>(&checkpoint), sizeof(checkpoint))) {
+         return false;
+      }
+   }
+#ifdef _WIN32
+   return MoveFileExA(tempName.c_str(), fileName.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+   return std::rename(tempName.c_str(), fileName.c_str()) == 0;
+#endif
+}
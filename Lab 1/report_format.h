@@ -0,0 +1,331 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "employee.h"
+#include "mapped_file.h"
+#include "employee_file.h"
+#include "salary_kernel.h"
+#include "rate_table.h"
+#include "money.h"
+
+// Ручное форматирование, дающее байт в байт отчёт iostream: столбцы
+// выровнены влево по REPORT_COLUMN_WIDTH, часы самой первой строки выводятся
+// форматом по умолчанию (точность 6), а все следующие значения - fixed с
+// двумя знаками, потому что std::fixed остаётся установленным в потоке.
+
+constexpr size_t REPORT_COLUMN_WIDTH = 15;
+constexpr size_t REPORT_MAX_ROW_SIZE = 1024;
+constexpr size_t RATE_PREFETCH_DISTANCE = 16;
+static_assert(EmployeeSchema::FieldAt<0>::width == REPORT_COLUMN_WIDTH, "listing columns match the report");
+
+#ifdef _WIN32
+constexpr char REPORT_NEWLINE[] = "\r\n";
+#else
+constexpr char REPORT_NEWLINE[] = "\n";
+#endif
+constexpr size_t REPORT_NEWLINE_SIZE = sizeof(REPORT_NEWLINE) - 1;
+
+inline char* padColumn(char* begin, char* end) {
+   size_t length = static_cast<size_t>(end - begin);
+   if (length < REPORT_COLUMN_WIDTH) {
+      std::memset(end, ' ', REPORT_COLUMN_WIDTH - length);
+      return begin + REPORT_COLUMN_WIDTH;
+   }
+   return end;
+}
+
+inline char* putNewline(char* p) {
+   std::memcpy(p, REPORT_NEWLINE, REPORT_NEWLINE_SIZE);
+   return p + REPORT_NEWLINE_SIZE;
+}
+
+inline size_t employeeNameLength(const employee& person) {
+   return EmployeeSchema::FieldAt<1>::Codec::length(person.name);
+}
+
+// Пишет одну строку отчёта в p (свободно не меньше REPORT_MAX_ROW_SIZE байт)
+// и возвращает позицию после неё.
+inline char* formatReportRow(char* p, const employee& person, Money salary, bool firstRow) {
+   char* limit = p + REPORT_MAX_ROW_SIZE;
+
+   p = EmployeeSchema::FieldAt<0>::format(person, p);
+   p = EmployeeSchema::FieldAt<1>::format(person, p);
+
+   char* hoursEnd = firstRow
+      ? std::to_chars(p, limit, person.hours, std::chars_format::general, 6).ptr
+      : std::to_chars(p, limit, person.hours, std::chars_format::fixed, 2).ptr;
+   p = padColumn(p, hoursEnd);
+
+   p = padColumn(p, putMoney(p, limit, salary));
+   return putNewline(p);
+}
+
+// Строка листинга двоичного файла в Main: num, name и hours так, как их
+// по умолчанию печатает cout (без столбца зарплаты).
+inline char* formatListingRow(char* p, const employee& person) {
+   p = EmployeeSchema::format(person, p);
+   *p++ = '\n';
+   return p;
+}
+
+// Машиночитаемые форматы отчёта (--format). В CSV и JSONL часы выводятся
+// кратчайшей точной записью, зарплата - с двумя знаками, строки
+// завершаются "\n" на любой платформе. Двоичный отчёт - заголовок
+// BinaryReportHeader и строки по BINARY_REPORT_ROW_SIZE байт без
+// выравнивания: num (int32), name[10], hours, salary (double).
+enum class ReportFormat {
+   TEXT,
+   CSV,
+   JSONL,
+   BINARY
+};
+
+inline bool parseReportFormat(const std::string& text, ReportFormat& format) {
+   if (text == "text") format = ReportFormat::TEXT;
+   else if (text == "csv") format = ReportFormat::CSV;
+   else if (text == "jsonl") format = ReportFormat::JSONL;
+   else if (text == "binary") format = ReportFormat::BINARY;
+   else return false;
+   return true;
+}
+
+constexpr char BINARY_REPORT_MAGIC[4] = { 'E', 'R', 'P', 'T' };
+constexpr uint32_t BINARY_REPORT_VERSION = 1;
+constexpr size_t BINARY_REPORT_ROW_SIZE = EmployeeSchema::packedSize + sizeof(double);
+
+struct BinaryReportHeader {
+   char magic[4];
+   uint32_t version;
+   uint32_t rowSize;
+   uint32_t reserved;
+};
+
+inline char* formatCsvRow(char* p, const employee& person, Money salary) {
+   char* limit = p + REPORT_MAX_ROW_SIZE;
+   p = std::to_chars(p, limit, person.num).ptr;
+   *p++ = ',';
+   size_t nameLength = employeeNameLength(person);
+   bool quote = std::find_if(person.name, person.name + nameLength,
+      [](char c) { return c == ',' || c == '"' || c == '\r' || c == '\n'; }) != person.name + nameLength;
+   if (quote) {
+      *p++ = '"';
+      for (size_t i = 0; i < nameLength; i++) {
+         if (person.name[i] == '"') {
+            *p++ = '"';
+         }
+         *p++ = person.name[i];
+      }
+      *p++ = '"';
+   }
+   else {
+      std::memcpy(p, person.name, nameLength);
+      p += nameLength;
+   }
+   *p++ = ',';
+   p = std::to_chars(p, limit, person.hours).ptr;
+   *p++ = ',';
+   p = putMoney(p, limit, salary);
+   *p++ = '\n';
+   return p;
+}
+
+// У NaN и бесконечности нет записи в JSON: они выводятся как null.
+inline char* formatJsonNumber(char* p, char* limit, double value, bool money) {
+   if (!std::isfinite(value)) {
+      std::memcpy(p, "null", 4);
+      return p + 4;
+   }
+   return money ? std::to_chars(p, limit, value, std::chars_format::fixed, 2).ptr
+      : std::to_chars(p, limit, value).ptr;
+}
+
+inline char* formatJsonRow(char* p, const employee& person, Money salary) {
+   static const char hexDigits[] = "0123456789abcdef";
+   char* limit = p + REPORT_MAX_ROW_SIZE;
+   std::memcpy(p, "{\"num\":", 7);
+   p = std::to_chars(p + 7, limit, person.num).ptr;
+   std::memcpy(p, ",\"name\":\"", 9);
+   p += 9;
+   size_t nameLength = employeeNameLength(person);
+   for (size_t i = 0; i < nameLength; i++) {
+      unsigned char c = static_cast<unsigned char>(person.name[i]);
+      if (c == '"' || c == '\\') {
+         *p++ = '\\';
+         *p++ = static_cast<char>(c);
+      }
+      else if (c < 0x20) {
+         std::memcpy(p, "\\u00", 4);
+         p[4] = hexDigits[c >> 4];
+         p[5] = hexDigits[c & 15];
+         p += 6;
+      }
+      else {
+         *p++ = static_cast<char>(c);
+      }
+   }
+   std::memcpy(p, "\",\"hours\":", 10);
+   p = formatJsonNumber(p + 10, limit, person.hours, false);
+   std::memcpy(p, ",\"salary\":", 10);
+   p = salary.exact ? formatCents(p + 10, salary.cents) : formatJsonNumber(p + 10, limit, salary.value, true);
+   std::memcpy(p, "}\n", 2);
+   return p + 2;
+}
+
+inline char* formatBinaryRow(char* p, const employee& person, Money salary) {
+   p = EmployeeSchema::pack(person, p);
+   std::memcpy(p, &salary.value, sizeof(double));
+   return p + sizeof(double);
+}
+
+inline char* formatReportRow(ReportFormat format, char* p, const employee& person, Money salary, bool firstRow) {
+   switch (format) {
+   case ReportFormat::CSV: return formatCsvRow(p, person, salary);
+   case ReportFormat::JSONL: return formatJsonRow(p, person, salary);
+   case ReportFormat::BINARY: return formatBinaryRow(p, person, salary);
+   default: return formatReportRow(p, person, salary, firstRow);
+   }
+}
+
+inline std::string formatReportHeader(const std::string& binFileName, ReportFormat format = ReportFormat::TEXT) {
+   switch (format) {
+   case ReportFormat::CSV:
+      return "num,name,hours,salary\n";
+   case ReportFormat::JSONL:
+      return std::string();
+   case ReportFormat::BINARY: {
+      BinaryReportHeader header = {};
+      std::memcpy(header.magic, BINARY_REPORT_MAGIC, sizeof(header.magic));
+      header.version = BINARY_REPORT_VERSION;
+      header.rowSize = BINARY_REPORT_ROW_SIZE;
+      return std::string(reinterpret_cast<const char*>(&header), sizeof(header));
+   }
+   default:
+      break;
+   }
+   std::string header = "\tReport on the file \"" + binFileName + "\":" + REPORT_NEWLINE;
+   header += "Employee ID    Employee name  Employee hours Employee salary";
+   header += REPORT_NEWLINE;
+   return header;
+}
+
+// Дописывает в out строки записей [first, last) файла. Формат первой
+// строки получает запись 0 файла, если файл начинает отчёт (startsReport).
+// С rates зарплата считается по таблице ставок, xPerHour - ставка по
+// умолчанию. С exact зарплаты считаются в целых копейках (см. money.h);
+// false, если такая зарплата вне диапазона.
+inline bool formatReportRange(const EmployeeFile& file, uint64_t first, uint64_t last, double xPerHour,
+   std::string& out, ReportFormat format = ReportFormat::TEXT, bool startsReport = true,
+   const RateTable* rates = nullptr, bool exact = false) {
+   constexpr size_t BATCH = 256;
+   employee batch[BATCH];
+   double hours[BATCH];
+   double salaries[BATCH];
+   int64_t cents[BATCH];
+   int64_t rateCents = toHundredths(xPerHour);
+   bool inRange = true;
+   size_t used = out.size();
+   for (uint64_t i = first; i < last; i += BATCH) {
+      size_t n = static_cast<size_t>(std::min<uint64_t>(BATCH, last - i));
+      file.read(i, n, batch);
+      if (exact) {
+         for (size_t j = 0; j < n; j++) {
+            int64_t rate = rates != nullptr ? toHundredths(rates->rate(batch[j].num, xPerHour)) : rateCents;
+            cents[j] = salaryCents(batch[j].hours, rate);
+            inRange = inRange && cents[j] != MONEY_INVALID;
+         }
+      }
+      else if (rates != nullptr) {
+         // Слоты таблицы запрашиваются на RATE_PREFETCH_DISTANCE записей вперёд.
+         for (size_t j = 0; j < std::min(n, RATE_PREFETCH_DISTANCE); j++) {
+            rates->prefetch(batch[j].num);
+         }
+         for (size_t j = 0; j < n; j++) {
+            if (j + RATE_PREFETCH_DISTANCE < n) {
+               rates->prefetch(batch[j + RATE_PREFETCH_DISTANCE].num);
+            }
+            salaries[j] = batch[j].hours * rates->rate(batch[j].num, xPerHour);
+         }
+      }
+      else {
+         for (size_t j = 0; j < n; j++) {
+            hours[j] = batch[j].hours;
+         }
+         computeSalaries(hours, salaries, n, xPerHour);
+      }
+
+      for (size_t j = 0; j < n; j++) {
+         if (out.size() - used < REPORT_MAX_ROW_SIZE) {
+            out.resize(out.size() * 2 + REPORT_MAX_ROW_SIZE);
+         }
+         Money salary = exact ? Money::fromCents(cents[j]) : Money(salaries[j]);
+         char* end = formatReportRow(format, &out[used], batch[j], salary, startsReport && i + j == 0);
+         used = end - out.data();
+      }
+   }
+   out.resize(used);
+   return inRange;
+}
+
+// Собирает строки отчёта, идущие в произвольном порядке (сортировка,
+// поиск...), и пишет их в файл отчёта крупными блоками.
+class ReportWriter {
+public:
+   static constexpr size_t BUFFER_SIZE = 4 << 20;
+
+   ReportWriter(OutputFile& out, double xPerHour, ReportFormat format = ReportFormat::TEXT,
+      const RateTable* rates = nullptr, bool exact = false)
+      : out(out), xPerHour(xPerHour), format(format), rates(rates), exact(exact),
+        buffer(BUFFER_SIZE), position(buffer.data()) {}
+   ReportWriter(const ReportWriter&) = delete;
+   ReportWriter& operator=(const ReportWriter&) = delete;
+
+   void writeHeader(const std::string& binFileName) {
+      std::string header = formatReportHeader(binFileName, format);
+      append(header.data(), header.size());
+   }
+
+   void append(const char* data, size_t size) {
+      flush();
+      ok = ok && out.write(data, size);
+   }
+
+   void operator()(const employee& person) {
+      double rate = rates != nullptr ? rates->rate(person.num, xPerHour) : xPerHour;
+      Money salary = exact ? Money::fromCents(salaryCents(person.hours, toHundredths(rate))) : Money(person.hours * rate);
+      outOfRange = outOfRange || (exact && salary.cents == MONEY_INVALID);
+      position = formatReportRow(format, position, person, salary, rows == 0);
+      rows++;
+      if (position >= buffer.data() + buffer.size() - REPORT_MAX_ROW_SIZE) {
+         flush();
+      }
+   }
+
+   // Строки с зарплатой вне диапазона в отчёт не попадают.
+   bool flush() {
+      ok = ok && !outOfRange && out.write(buffer.data(), position - buffer.data());
+      position = buffer.data();
+      return ok;
+   }
+
+   unsigned long long rowCount() const { return rows; }
+   bool isOutOfRange() const { return outOfRange; }
+
+private:
+   OutputFile& out;
+   double xPerHour;
+   ReportFormat format;
+   const RateTable* rates;
+   bool exact;
+   std::vector<char> buffer;
+   char* position;
+   unsigned long long rows = 0;
+   bool ok = true;
+   bool outOfRange = false;
+};
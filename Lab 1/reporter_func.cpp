@@ -0,0 +1,1184 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <iomanip>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <limits>
+#include <sstream>
+#include <unordered_map>
+#include "employee_io.h"
+#include "employee.h"
+#include "mapped_file.h"
+#include "employee_file.h"
+#include "report_format.h"
+#include "external_sort.h"
+#include "employee_index.h"
+#include "employee_checksum.h"
+#include "report_checkpoint.h"
+#include "aggregate_report.h"
+#include "radix_sort.h"
+#include "block_reader.h"
+#include "process.h"
+#include "file_watch.h"
+
+constexpr size_t RECORDS_PER_CHUNK = 1 << 16;
+
+bool parseReporterArguments(int argc, char* argv[], ReporterOptions& options) {
+   std::vector<std::string> positional;
+   for (int i = 1; i < argc; i++) {
+      std::string arg = argv[i];
+      if (arg == "--mmap") {
+         options.useMapping = true;
+      }
+      else if (arg == "--threads" && i + 1 < argc) {
+         int threads;
+         if (!parseNumber(argv[++i], threads)) {
+            return false;
+         }
+         options.useMapping = true;
+         options.threads = std::max(1, threads);
+      }
+      else if (arg == "--sort" && i + 1 < argc) {
+         if (!parseSortKey(argv[++i], options.sortKey)) {
+            return false;
+         }
+      }
+      else if (arg == "--mem" && i + 1 < argc) {
+         if (!parseMemorySize(argv[++i], options.sortMemory)) {
+            return false;
+         }
+      }
+      else if (arg == "--lookup" && i + 1 < argc) {
+         options.lookupList = argv[++i];
+      }
+      else if (arg == "--format" && i + 1 < argc) {
+         if (!parseReportFormat(argv[++i], options.format)) {
+            return false;
+         }
+      }
+      else if (arg == "--io" && i + 1 < argc) {
+         if (!parseIoMethod(argv[++i], options.ioMethod)) {
+            return false;
+         }
+      }
+      else if (arg == "--direct") {
+         options.directIo = true;
+         if (options.ioMethod == IoMethod::DEFAULT) {
+            options.ioMethod = IoMethod::PREAD;
+         }
+      }
+      else if (arg == "--label" && i + 1 < argc) {
+         options.label = argv[++i];
+      }
+      else if (arg == "--incremental") {
+         options.incremental = true;
+      }
+      else if (arg == "--summary") {
+         options.summary = true;
+      }
+      else if (arg == "--top" && i + 1 < argc) {
+         int top;
+         if (!parseNumber(argv[++i], top)) {
+            return false;
+         }
+         options.summary = true;
+         options.topCount = static_cast<size_t>(std::max(0, top));
+      }
+      else if (arg == "--stats") {
+         options.printStats = true;
+      }
+      else if (arg == "--rates" && i + 1 < argc) {
+         options.rateFileName = argv[++i];
+      }
+      else if (arg == "--follow") {
+         options.follow = true;
+      }
+      else if (arg == "--exact") {
+         options.exactMoney = true;
+      }
+      else if (arg == "--merge") {
+         options.mergeByNum = true;
+      }
+      else {
+         positional.push_back(arg);
+      }
+   }
+   if (positional.size() < 3) {
+      return false;
+   }
+   // <binary file>... <report file> <payment per hour>
+   size_t inputs = positional.size() - 2;
+   options.binFileName = positional[0];
+   options.extraBinFileNames.assign(positional.begin() + 1, positional.begin() + inputs);
+   options.reportFileName = positional[inputs];
+   return parseNumber(positional[inputs + 1], options.xPerHour);
+}
+
+long long writeStreamReport(const ReporterOptions& options) {
+   std::ifstream in(options.binFileName, std::ios::binary);
+   if (!in) {
+      std::cout << "Error: cannot open file " << options.binFileName << " for reading\n";
+      return -1;
+   }
+
+   // Открываем текстовый файл для отчёта
+   std::ofstream out(options.reportFileName);
+   if (!out) {
+      std::cout << "Error: cannot open file " << options.reportFileName << " for writing\n";
+      return -1;
+   }
+
+   out << "\tReport on the file \"" << options.label << "\":\n";
+   out << std::left << std::setw(15) << "Employee ID";
+   out << std::left << std::setw(15) << "Employee name";
+   out << std::left << std::setw(15) << "Employee hours";
+   out << std::left << std::setw(15) << "Employee salary\n";
+
+   long long count = 0;
+   employee person;
+   while (in.read(reinterpret_cast<char*>(&person), sizeof(employee))) {
+      double salary = person.hours * options.xPerHour;
+      out << std::left << std::setw(15) << person.num
+          << std::setw(15) << person.name
+          << std::setw(15) << person.hours
+          << std::setw(15) << std::fixed << std::setprecision(2) << salary
+          << "\n";
+      count++;
+   }
+
+   in.close();
+   out.close();
+   return count;
+}
+
+// Контрольные суммы блоков, с которыми сверяется файл исходного формата;
+// false, если их нет. Об устаревших суммах выводится предупреждение, и
+// они не используются.
+bool openChecksums(const ReporterOptions& options, const EmployeeFile& in, EmployeeChecksums& checksums) {
+   if (in.format() != EmployeeFormat::LEGACY || !checksums.open(options.binFileName)) {
+      return false;
+   }
+   if (!checksums.isFresh(fileSize(options.binFileName), in.count())) {
+      std::cout << "Warning: checksums " << checksumFileName(options.binFileName)
+                << " are stale, the file is not verified\n";
+      return false;
+   }
+   return true;
+}
+
+void reportChecksumMismatch(const ReporterOptions& options, uint64_t block) {
+   std::cout << "Error: checksum mismatch in block " << block << " (records from "
+             << block * CHECKSUM_BLOCK_RECORDS << ") of file " << options.binFileName << "\n";
+}
+
+// Повреждённый блок архива читается нулями: такой отчёт не выдаётся.
+bool reportDamage(const EmployeeFile& in, const std::string& fileName) {
+   if (in.isDamaged()) {
+      std::cout << "Error: file " << fileName << " is damaged\n";
+   }
+   return in.isDamaged();
+}
+
+// С --exact зарплата вне диапазона money.h не печатается: отчёт не выдаётся.
+bool reportMoneyRange(bool outOfRange) {
+   if (outOfRange) {
+      std::cout << "Error: hours or rate out of range for --exact (up to " << static_cast<long long>(MONEY_LIMIT) << ")\n";
+   }
+   return outOfRange;
+}
+
+bool flushReport(ReportWriter& writer, const ReporterOptions& options) {
+   if (reportMoneyRange(writer.isOutOfRange())) {
+      return false;
+   }
+   if (!writer.flush()) {
+      std::cout << "Error: cannot write to file " << options.reportFileName << "\n";
+      return false;
+   }
+   return true;
+}
+
+// Строки записей [first, last) форматируются параллельно: диапазон делится
+// на куски целых записей, потоки пула (options.threads, запускаются один
+// раз) берут номера кусков по очереди и форматируют каждый в свой буфер из
+// кольца на два буфера на поток. Готовые куски пишутся строго по порядку,
+// пока потоки заняты следующими.
+// С checksums каждый поток перед форматированием своего куска проверяет
+// блоки, которые в нём начинаются: данные после проверки уже в кэше.
+// Строки повреждённого куска не пишутся, его первый плохой блок
+// возвращается в badBlock. Так же останавливает отчёт зарплата вне
+// диапазона (outOfRange).
+bool writeReportRows(const EmployeeFile& in, uint64_t first, uint64_t last,
+   const ReporterOptions& options, OutputFile& out,
+   const EmployeeChecksums* checksums, uint64_t& badBlock, bool& outOfRange, bool startsReport = true) {
+   uint64_t chunks = (last - first + RECORDS_PER_CHUNK - 1) / RECORDS_PER_CHUNK;
+   size_t threads = static_cast<size_t>(std::min<uint64_t>(options.threads, chunks));
+   size_t slots = 2 * std::max<size_t>(threads, 1);
+   std::vector<std::string> texts(slots);
+   std::vector<uint64_t> slotBadBlock(slots);
+   std::vector<char> slotOutOfRange(slots), slotDone(slots);
+   // Номера кусков, флаги slotDone и остановка - под mutex.
+   std::mutex mutex;
+   std::condition_variable wake;
+   uint64_t nextChunk = 0;
+   uint64_t writtenChunks = 0;
+   bool stopping = false;
+   badBlock = NO_BAD_BLOCK;
+   outOfRange = false;
+
+   auto formatChunk = [&](size_t slot, uint64_t chunkFirst, uint64_t chunkLast) {
+      texts[slot].clear();
+      slotBadBlock[slot] = NO_BAD_BLOCK;
+      slotOutOfRange[slot] = false;
+      if (checksums != nullptr) {
+         // Блок, в середине которого начинается диапазон (дописанные после
+         // контрольной точки записи), проверяется первым куском целиком.
+         uint64_t block = chunkFirst == first ? chunkFirst / CHECKSUM_BLOCK_RECORDS
+            : (chunkFirst + CHECKSUM_BLOCK_RECORDS - 1) / CHECKSUM_BLOCK_RECORDS;
+         for (; block * CHECKSUM_BLOCK_RECORDS < chunkLast; block++) {
+            if (!checksums->verify(in.data(), in.count(), block)) {
+               slotBadBlock[slot] = block;
+               return;
+            }
+         }
+      }
+      slotOutOfRange[slot] = !formatReportRange(in, chunkFirst, chunkLast, options.xPerHour, texts[slot],
+         options.format, startsReport, options.rates.get(), options.exactMoney);
+   };
+
+   auto work = [&] {
+      std::unique_lock<std::mutex> lock(mutex);
+      while (!stopping && nextChunk < chunks) {
+         uint64_t chunk = nextChunk++;
+         // Буфер свободен, когда записан кусок, занимавший его раньше.
+         wake.wait(lock, [&] { return stopping || chunk < writtenChunks + slots; });
+         if (stopping) {
+            break;
+         }
+         lock.unlock();
+         uint64_t chunkFirst = first + chunk * RECORDS_PER_CHUNK;
+         formatChunk(chunk % slots, chunkFirst, std::min<uint64_t>(last, chunkFirst + RECORDS_PER_CHUNK));
+         lock.lock();
+         slotDone[chunk % slots] = true;
+         wake.notify_all();
+      }
+   };
+   std::vector<std::thread> workers;
+   for (size_t t = 0; t < threads; t++) {
+      workers.emplace_back(work);
+   }
+
+   bool written = true;
+   std::vector<std::string> batch;
+   while (written && writtenChunks < chunks) {
+      // Пишутся разом все готовые подряд куски.
+      uint64_t end = writtenChunks;
+      {
+         std::unique_lock<std::mutex> lock(mutex);
+         wake.wait(lock, [&] { return slotDone[writtenChunks % slots] != 0; });
+         while (end < chunks && end < writtenChunks + slots && slotDone[end % slots]) {
+            end++;
+         }
+      }
+      for (uint64_t chunk = writtenChunks; chunk < end; chunk++) {
+         size_t slot = chunk % slots;
+         if (slotBadBlock[slot] != NO_BAD_BLOCK || slotOutOfRange[slot]) {
+            badBlock = slotBadBlock[slot];
+            outOfRange = slotOutOfRange[slot] != 0;
+            end = chunk;
+            break;
+         }
+         batch.push_back(std::move(texts[slot]));
+      }
+      bool failed = badBlock != NO_BAD_BLOCK || outOfRange || in.isDamaged();
+      written = failed || out.writeGather(batch);
+      // Строки возвращаются в буферы, чтобы не выделять память заново.
+      for (uint64_t chunk = writtenChunks; chunk < end; chunk++) {
+         texts[chunk % slots] = std::move(batch[chunk - writtenChunks]);
+      }
+      batch.clear();
+
+      std::lock_guard<std::mutex> lock(mutex);
+      for (uint64_t chunk = writtenChunks; chunk < end; chunk++) {
+         slotDone[chunk % slots] = false;
+      }
+      writtenChunks = end;
+      stopping = failed || !written;
+      wake.notify_all();
+      if (stopping) {
+         break;
+      }
+   }
+
+   {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+   }
+   wake.notify_all();
+   for (std::thread& worker : workers) {
+      worker.join();
+   }
+   return written;
+}
+
+long long writeMappedReport(const ReporterOptions& options) {
+   EmployeeFile in;
+   if (!in.open(options.binFileName)) {
+      std::cout << "Error: cannot open file " << options.binFileName << " for reading\n";
+      return -1;
+   }
+
+   OutputFile out;
+   if (!out.open(options.reportFileName)) {
+      std::cout << "Error: cannot open file " << options.reportFileName << " for writing\n";
+      return -1;
+   }
+
+   EmployeeChecksums checksums;
+   bool verify = openChecksums(options, in, checksums);
+   uint64_t badBlock;
+   bool outOfRange;
+   std::string header = formatReportHeader(options.label, options.format);
+   if (!out.write(header.data(), header.size())
+      || !writeReportRows(in, 0, in.count(), options, out, verify ? &checksums : nullptr, badBlock, outOfRange)) {
+      std::cout << "Error: cannot write to file " << options.reportFileName << "\n";
+      return -1;
+   }
+   if (badBlock != NO_BAD_BLOCK) {
+      reportChecksumMismatch(options, badBlock);
+      return -1;
+   }
+   if (reportDamage(in, options.binFileName) || reportMoneyRange(outOfRange)) {
+      return -1;
+   }
+   return static_cast<long long>(in.count());
+}
+
+struct ReportInput {
+   std::string fileName;
+   EmployeeFile file;
+   EmployeeAggregate subtotal;
+   // Для слияния: файл исходного формата, отсортированный по num.
+   std::string sortedFileName;
+   bool sortedCopy = false;
+   bool ok = true;
+};
+
+bool isSortedByNum(const EmployeeFile& file) {
+   const employee* records = reinterpret_cast<const employee*>(file.data());
+   for (uint64_t i = 1; i < file.count(); i++) {
+      if (records[i].num < records[i - 1].num) {
+         return false;
+      }
+   }
+   return true;
+}
+
+// С exact суммы зарплат выводятся из точных копеек.
+std::string formatSubtotals(const std::vector<ReportInput>& inputs, bool exact) {
+   std::ostringstream text;
+   text << "\tSubtotals:\n" << std::left;
+   text << std::setw(15) << "Employees" << std::setw(15) << "Total hours"
+        << std::setw(15) << "Total salary" << "File\n";
+   text << std::fixed << std::setprecision(2);
+   EmployeeAggregate total;
+   for (const ReportInput& input : inputs) {
+      text << std::setw(15) << input.subtotal.count << std::setw(15) << input.subtotal.totalHours
+           << std::setw(15);
+      if (exact) {
+         text << centsString(input.subtotal.totalCents);
+      }
+      else {
+         text << input.subtotal.totalSalary;
+      }
+      text << input.fileName << "\n";
+      total.merge(input.subtotal);
+   }
+   text << std::setw(15) << total.count << std::setw(15) << total.totalHours << std::setw(15);
+   if (exact) {
+      text << centsString(total.totalCents);
+   }
+   else {
+      text << total.totalSalary;
+   }
+   text << "All files\n";
+   return text.str();
+}
+
+// Один отчёт по нескольким файлам. Сначала файлы обрабатываются
+// параллельно, по потоку на файл: считаются итоги по файлу, а для --merge
+// файлы, не упорядоченные по num, сортируются во временные. Затем строки
+// идут либо подряд в порядке файлов (каждый файл форматируется --threads
+// потоками), либо k-путевым слиянием по num; записи с равными num - в
+// порядке файлов. Итоги по файлам дописываются в конец текстового отчёта,
+// для остальных форматов выводятся на консоль.
+long long writeMultiFileReport(const ReporterOptions& options) {
+   std::vector<std::string> names = { options.binFileName };
+   names.insert(names.end(), options.extraBinFileNames.begin(), options.extraBinFileNames.end());
+   std::vector<ReportInput> inputs(names.size());
+   for (size_t i = 0; i < names.size(); i++) {
+      inputs[i].fileName = names[i];
+      if (!inputs[i].file.open(names[i])) {
+         std::cout << "Error: cannot open file " << names[i] << " for reading\n";
+         return -1;
+      }
+   }
+
+   OutputFile out;
+   if (!out.open(options.reportFileName)) {
+      std::cout << "Error: cannot open file " << options.reportFileName << " for writing\n";
+      return -1;
+   }
+
+   EmployeeLess byNum{ SortKey::NUM, options.xPerHour, options.rates.get() };
+   size_t sortMemory = options.sortMemory / inputs.size();
+   std::vector<std::thread> workers;
+   for (size_t i = 0; i < inputs.size(); i++) {
+      workers.emplace_back([&, i] {
+         ReportInput& input = inputs[i];
+         aggregateRange(input.file, 0, input.file.count(), options.xPerHour, input.subtotal, options.rates.get(),
+            options.exactMoney);
+         if (!options.mergeByNum) {
+            return;
+         }
+         // При слиянии записи читаются не по кускам, поэтому файл с
+         // контрольными суммами проверяется целиком здесь.
+         ReporterOptions fileOptions = options;
+         fileOptions.binFileName = input.fileName;
+         EmployeeChecksums checksums;
+         if (openChecksums(fileOptions, input.file, checksums)) {
+            for (uint64_t block = 0; block * CHECKSUM_BLOCK_RECORDS < input.file.count(); block++) {
+               if (!checksums.verify(input.file.data(), input.file.count(), block)) {
+                  reportChecksumMismatch(fileOptions, block);
+                  input.ok = false;
+                  return;
+               }
+            }
+         }
+         if (input.file.format() == EmployeeFormat::LEGACY && isSortedByNum(input.file)) {
+            input.sortedFileName = input.fileName;
+            return;
+         }
+         input.sortedFileName = options.reportFileName + ".in" + std::to_string(i);
+         input.sortedCopy = true;
+         RunWriter writer(input.sortedFileName, MIN_RUN_BUFFER_RECORDS);
+         input.ok = writer.isOpen() && externalSort(input.file, input.sortedFileName, byNum, sortMemory, writer) >= 0
+            && writer.flush();
+      });
+   }
+   for (std::thread& worker : workers) {
+      worker.join();
+   }
+
+   uint64_t count = 0;
+   bool written = true;
+   bool ok = true;
+   bool outOfRange = false;
+   for (const ReportInput& input : inputs) {
+      count += input.file.count();
+      ok = ok && input.ok;
+      outOfRange = outOfRange || input.subtotal.moneyOutOfRange;
+   }
+   // Подытоги уже посчитаны по всем записям, так что строки не нужны.
+   ok = !reportMoneyRange(outOfRange) && ok;
+   std::string header = formatReportHeader(options.label, options.format);
+   if (ok && options.mergeByNum) {
+      std::vector<std::string> runs;
+      for (const ReportInput& input : inputs) {
+         runs.push_back(input.sortedFileName);
+      }
+      ReportWriter writer(out, options.xPerHour, options.format, options.rates.get(), options.exactMoney);
+      writer.append(header.data(), header.size());
+      size_t bufferRecords = std::max(options.sortMemory / sizeof(employee) / (runs.size() + 1), MIN_RUN_BUFFER_RECORDS);
+      ok = mergeRuns(runs, bufferRecords, byNum, writer);
+      written = writer.flush();
+   }
+   else if (ok) {
+      written = out.write(header.data(), header.size());
+      bool startsReport = true;
+      for (size_t i = 0; i < inputs.size() && written && ok; i++) {
+         ReporterOptions fileOptions = options;
+         fileOptions.binFileName = inputs[i].fileName;
+         EmployeeChecksums checksums;
+         bool verify = openChecksums(fileOptions, inputs[i].file, checksums);
+         uint64_t badBlock;
+         bool rowsOutOfRange;
+         written = writeReportRows(inputs[i].file, 0, inputs[i].file.count(), fileOptions, out,
+            verify ? &checksums : nullptr, badBlock, rowsOutOfRange, startsReport);
+         if (badBlock != NO_BAD_BLOCK) {
+            reportChecksumMismatch(fileOptions, badBlock);
+            ok = false;
+         }
+         ok = ok && !inputs[i].file.isDamaged();
+         startsReport = startsReport && inputs[i].file.count() == 0;
+      }
+   }
+   for (const ReportInput& input : inputs) {
+      ok = !reportDamage(input.file, input.fileName) && ok;
+   }
+   for (const ReportInput& input : inputs) {
+      if (input.sortedCopy) {
+         std::remove(input.sortedFileName.c_str());
+      }
+   }
+   if (!ok) {
+      return -1;
+   }
+
+   std::string subtotals = formatSubtotals(inputs, options.exactMoney);
+   if (options.format == ReportFormat::TEXT) {
+      written = written && out.write(subtotals.data(), subtotals.size());
+   }
+   else {
+      std::cout << subtotals;
+   }
+   if (!written) {
+      std::cout << "Error: cannot write to file " << options.reportFileName << "\n";
+      return -1;
+   }
+   return static_cast<long long>(count);
+}
+
+// Отчёт с последовательным чтением файла блоками (--io pread|uring): пока
+// форматируется один блок, следующие уже читаются. С --direct файл читается
+// мимо кэша страниц. Запись, разрезанная границей блока, собирается из двух
+// кусков. Только исходный формат.
+long long writeBlockReadReport(const ReporterOptions& options) {
+   BlockReader reader;
+   if (!reader.open(options.binFileName, options.ioMethod, options.directIo)) {
+      std::cout << "Error: cannot open file " << options.binFileName << " for reading\n";
+      return -1;
+   }
+   if (options.ioMethod == IoMethod::URING && reader.method() != IoMethod::URING) {
+      std::cout << "Warning: io_uring is not available, reading with pread\n";
+   }
+   if (options.directIo && !reader.isDirect()) {
+      std::cout << "Warning: direct I/O is not supported for " << options.binFileName
+                << ", dropping its pages from the cache instead\n";
+   }
+
+   OutputFile out;
+   if (!out.open(options.reportFileName)) {
+      std::cout << "Error: cannot open file " << options.reportFileName << " for writing\n";
+      return -1;
+   }
+   ReportWriter writer(out, options.xPerHour, options.format, options.rates.get(), options.exactMoney);
+   writer.writeHeader(options.label);
+
+   // С контрольными суммами прочитанное копится по блокам CHECKSUM_BLOCK_RECORDS
+   // записей, и строки блока пишутся только после его проверки.
+   EmployeeFile in;
+   EmployeeChecksums checksums;
+   bool verify = in.open(options.binFileName) && openChecksums(options, in, checksums);
+   in.close();
+   std::vector<char> block(verify ? size_t(CHECKSUM_BLOCK_RECORDS) * sizeof(employee) : 0);
+   size_t blockFilled = 0;
+   uint64_t blockIndex = 0;
+
+   char partial[sizeof(employee)];
+   size_t partialSize = 0;
+   auto reportBytes = [&](const char* data, size_t size) {
+      employee person;
+      if (partialSize > 0) {
+         size_t take = std::min(sizeof(employee) - partialSize, size);
+         std::memcpy(partial + partialSize, data, take);
+         partialSize += take;
+         data += take;
+         size -= take;
+         if (partialSize == sizeof(employee)) {
+            std::memcpy(&person, partial, sizeof(employee));
+            writer(person);
+            partialSize = 0;
+         }
+      }
+      size_t whole = size / sizeof(employee) * sizeof(employee);
+      for (size_t offset = 0; offset < whole; offset += sizeof(employee)) {
+         std::memcpy(&person, data + offset, sizeof(employee));
+         writer(person);
+      }
+      std::memcpy(partial + partialSize, data + whole, size - whole);
+      partialSize += size - whole;
+   };
+   auto reportBlock = [&]() {
+      if (!checksums.verifyBytes(block.data(), blockFilled, blockIndex)) {
+         reportChecksumMismatch(options, blockIndex);
+         return false;
+      }
+      reportBytes(block.data(), blockFilled);
+      blockIndex++;
+      blockFilled = 0;
+      return true;
+   };
+
+   const char* data;
+   size_t size;
+   while (reader.next(data, size)) {
+      if (!verify) {
+         reportBytes(data, size);
+         continue;
+      }
+      while (size > 0) {
+         size_t take = std::min(size, block.size() - blockFilled);
+         std::memcpy(block.data() + blockFilled, data, take);
+         blockFilled += take;
+         data += take;
+         size -= take;
+         if (blockFilled == block.size() && !reportBlock()) {
+            return -1;
+         }
+      }
+   }
+   if (reader.error()) {
+      std::cout << "Error: cannot read file " << options.binFileName << "\n";
+      return -1;
+   }
+   if (verify && blockFilled > 0 && !reportBlock()) {
+      return -1;
+   }
+   if (!flushReport(writer, options)) {
+      return -1;
+   }
+   return static_cast<long long>(writer.rowCount());
+}
+
+// Инкрементальный отчёт (--incremental): если контрольная точка совпадает
+// с отчётом и началом файла данных, в конец отчёта дописываются только
+// строки новых записей, иначе отчёт строится заново. Возвращает число
+// отформатированных записей.
+long long writeIncrementalReport(const ReporterOptions& options) {
+   MappedFile data;
+   if (!data.open(options.binFileName)) {
+      std::cout << "Error: cannot open file " << options.binFileName << " for reading\n";
+      return -1;
+   }
+   EmployeeFile in;
+   in.open(options.binFileName);
+   if (in.format() != EmployeeFormat::LEGACY) {
+      // Колоночный файл и архив не дописываются в конец (индекс блоков стоит последним).
+      std::cout << "Warning: " << options.binFileName << " is not append-only, regenerating the whole report\n";
+      return writeMappedReport(options);
+   }
+
+   std::string header = formatReportHeader(options.label, options.format);
+   uint64_t count = in.count();
+   ReportCheckpoint checkpoint = {};
+   bool resume = readCheckpoint(options.reportFileName, checkpoint)
+      && checkpoint.xPerHour == options.xPerHour
+      && checkpoint.exactMoney == static_cast<uint32_t>(options.exactMoney)
+      && checkpoint.headerHash == hashBytes(header.data(), header.size())
+      && checkpoint.recordCount <= count
+      && checkpoint.dataOffset == checkpoint.recordCount * sizeof(employee)
+      && checkpoint.reportSize == fileSize(options.reportFileName)
+      && (checkpoint.recordCount == 0
+         || checkpoint.tailHash == hashBytes(data.data() + checkpoint.dataOffset - sizeof(employee), sizeof(employee)));
+
+   OutputFile out;
+   bool opened = resume ? out.openForAppend(options.reportFileName) : out.open(options.reportFileName);
+   if (!opened) {
+      std::cout << "Error: cannot open file " << options.reportFileName << " for writing\n";
+      return -1;
+   }
+   if (!resume) {
+      checkpoint = {};
+      checkpoint.xPerHour = options.xPerHour;
+      checkpoint.exactMoney = options.exactMoney;
+      checkpoint.headerHash = hashBytes(header.data(), header.size());
+      checkpoint.reportSize = header.size();
+      if (!out.write(header.data(), header.size())) {
+         std::cout << "Error: cannot write to file " << options.reportFileName << "\n";
+         return -1;
+      }
+   }
+
+   // Проверяются блоки, которые начинаются среди новых записей.
+   EmployeeChecksums checksums;
+   bool verify = openChecksums(options, in, checksums);
+   uint64_t first = checkpoint.recordCount;
+   uint64_t badBlock;
+   bool outOfRange;
+   if (!writeReportRows(in, first, count, options, out, verify ? &checksums : nullptr, badBlock, outOfRange)) {
+      std::cout << "Error: cannot write to file " << options.reportFileName << "\n";
+      return -1;
+   }
+   if (badBlock != NO_BAD_BLOCK) {
+      reportChecksumMismatch(options, badBlock);
+      return -1;
+   }
+   if (reportMoneyRange(outOfRange)) {
+      return -1;
+   }
+   out.close();
+
+   const employee* records = reinterpret_cast<const employee*>(data.data());
+   for (uint64_t i = first; i < count; i++) {
+      double rate = options.rates ? options.rates->rate(records[i].num, options.xPerHour) : options.xPerHour;
+      checkpoint.totalHours += records[i].hours;
+      checkpoint.totalSalary += records[i].hours * rate;
+      if (options.exactMoney) {
+         checkpoint.totalCents += salaryCents(records[i].hours, toHundredths(rate));
+      }
+   }
+   checkpoint.recordCount = count;
+   checkpoint.dataOffset = count * sizeof(employee);
+   if (count > 0) {
+      checkpoint.tailHash = hashBytes(data.data() + checkpoint.dataOffset - sizeof(employee), sizeof(employee));
+   }
+   checkpoint.reportSize = fileSize(options.reportFileName);
+   if (!writeCheckpoint(options.reportFileName, checkpoint)) {
+      std::cout << "Error: cannot write file " << checkpointFileName(options.reportFileName) << "\n";
+      return -1;
+   }
+   return static_cast<long long>(count - first);
+}
+
+// Упорядоченный список сотрудников: внешняя сортировка по выбранному ключу,
+// память ограничена --mem.
+long long writeSortedReport(const ReporterOptions& options) {
+   EmployeeFile in;
+   if (!in.open(options.binFileName)) {
+      std::cout << "Error: cannot open file " << options.binFileName << " for reading\n";
+      return -1;
+   }
+
+   OutputFile out;
+   if (!out.open(options.reportFileName)) {
+      std::cout << "Error: cannot open file " << options.reportFileName << " for writing\n";
+      return -1;
+   }
+
+   ReportWriter writer(out, options.xPerHour, options.format, options.rates.get(), options.exactMoney);
+   writer.writeHeader(options.label);
+   EmployeeLess less{ options.sortKey, options.xPerHour, options.rates.get() };
+   size_t runMemory = options.sortMemory > ReportWriter::BUFFER_SIZE
+      ? options.sortMemory - ReportWriter::BUFFER_SIZE : 0;
+   // По имени, если ключи помещаются в память, - поразрядная сортировка.
+   long long count = options.sortKey == SortKey::NAME && fitsRadixSort(in, runMemory)
+      ? radixSortByName(in, options.threads, writer)
+      : externalSort(in, options.reportFileName, less, runMemory, writer);
+   if (count < 0 || reportDamage(in, options.binFileName)) {
+      return -1;
+   }
+   if (!flushReport(writer, options)) {
+      return -1;
+   }
+   return count;
+}
+
+// Сводка по файлу за один проход: итоги, квантили часов и (--top K)
+// самые высокие зарплаты. Для колоночного файла читается только колонка hours.
+long long writeSummaryReport(const ReporterOptions& options) {
+   EmployeeFile in;
+   if (!in.open(options.binFileName)) {
+      std::cout << "Error: cannot open file " << options.binFileName << " for reading\n";
+      return -1;
+   }
+
+   // Каждый поток считает агрегаты своей части файла, затем они объединяются.
+   uint64_t count = in.count();
+   size_t threads = static_cast<size_t>(std::max<uint64_t>(1, std::min<uint64_t>(options.threads, count / RECORDS_PER_CHUNK)));
+   std::vector<EmployeeAggregate> parts(threads, EmployeeAggregate(options.topCount));
+   std::vector<std::thread> workers;
+   for (size_t t = 0; t < threads; t++) {
+      uint64_t first = count * t / threads;
+      uint64_t last = count * (t + 1) / threads;
+      workers.emplace_back(aggregateRange, std::cref(in), first, last, options.xPerHour, std::ref(parts[t]),
+         options.rates.get(), options.exactMoney);
+   }
+   for (std::thread& worker : workers) {
+      worker.join();
+   }
+   if (reportDamage(in, options.binFileName)) {
+      return -1;
+   }
+   EmployeeAggregate total = parts[0];
+   for (size_t t = 1; t < threads; t++) {
+      total.merge(parts[t]);
+   }
+   if (reportMoneyRange(total.moneyOutOfRange)) {
+      return -1;
+   }
+
+   std::ofstream out(options.reportFileName);
+   if (!out) {
+      std::cout << "Error: cannot open file " << options.reportFileName << " for writing\n";
+      return -1;
+   }
+   out << "\tSummary of the file \"" << options.label << "\":\n";
+   out << std::left << std::setw(15) << "Employees" << count << "\n";
+   out << std::fixed << std::setprecision(2);
+   out << std::setw(15) << "Total hours" << total.totalHours << "\n";
+   out << std::setw(15) << "Total salary";
+   if (options.exactMoney) {
+      out << centsString(total.totalCents) << "\n";
+   }
+   else {
+      out << total.totalSalary << "\n";
+   }
+   if (count > 0) {
+      out << std::setw(15) << "Min hours" << total.minHours << "\n";
+      out << std::setw(15) << "Max hours" << total.maxHours << "\n";
+   }
+   if (total.hours.nonFinite() > 0) {
+      std::cout << "Warning: " << total.hours.nonFinite() << " records with NaN or infinite hours"
+                << " are left out of the quantiles\n";
+   }
+   if (total.hours.count() > 0) {
+      out << std::setw(15) << "P50 hours" << total.hours.quantile(0.50) << "\n";
+      out << std::setw(15) << "P90 hours" << total.hours.quantile(0.90) << "\n";
+      out << std::setw(15) << "P99 hours" << total.hours.quantile(0.99) << "\n";
+   }
+
+   if (options.topCount > 0) {
+      out << "\tTop " << options.topCount << " earners:\n";
+      out << std::setw(15) << "Employee ID" << std::setw(15) << "Employee name"
+          << std::setw(15) << "Employee hours" << "Employee salary\n";
+      for (const TopEarner& entry : total.top.sorted()) {
+         out << std::setw(15) << entry.person.num
+             << std::setw(15) << std::string(entry.person.name, employeeNameLength(entry.person))
+             << std::setw(15) << entry.person.hours
+             << std::setw(15);
+         if (options.exactMoney) {
+            double rate = options.rates ? options.rates->rate(entry.person.num, options.xPerHour) : options.xPerHour;
+            out << centsString(salaryCents(entry.person.hours, toHundredths(rate))) << "\n";
+         }
+         else {
+            out << entry.salary << "\n";
+         }
+      }
+   }
+   return static_cast<long long>(count);
+}
+
+// Список номеров: "5,17,42" или "@файл" с номерами через пробелы/строки.
+bool parseLookupList(const std::string& list, std::vector<int>& ids) {
+   std::string text = list;
+   if (!list.empty() && list[0] == '@') {
+      std::ifstream in(list.substr(1));
+      if (!in) {
+         std::cout << "Error: cannot open file " << list.substr(1) << " for reading\n";
+         return false;
+      }
+      text.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+   }
+   std::replace(text.begin(), text.end(), ',', ' ');
+   std::istringstream stream(text);
+   int id;
+   while (stream >> id) {
+      ids.push_back(id);
+   }
+   if (!stream.eof()) {
+      std::cout << "Error: invalid employee ID list\n";
+      return false;
+   }
+   return true;
+}
+
+// Отчёт только по заданным номерам. Записи ищутся двоичным поиском
+// по индексу <файл>.idx; если индекса нет или он устарел, файл
+// просматривается целиком.
+long long writeLookupReport(const ReporterOptions& options) {
+   std::vector<int> ids;
+   if (!parseLookupList(options.lookupList, ids)) {
+      return -1;
+   }
+
+   EmployeeFile in;
+   if (!in.open(options.binFileName)) {
+      std::cout << "Error: cannot open file " << options.binFileName << " for reading\n";
+      return -1;
+   }
+
+   OutputFile out;
+   if (!out.open(options.reportFileName)) {
+      std::cout << "Error: cannot open file " << options.reportFileName << " for writing\n";
+      return -1;
+   }
+   ReportWriter writer(out, options.xPerHour, options.format, options.rates.get(), options.exactMoney);
+   writer.writeHeader(options.label);
+
+   std::unordered_map<int, std::vector<employee>> found;
+   for (int id : ids) {
+      found[id];
+   }
+   EmployeeIndex index;
+   bool indexed = index.open(options.binFileName)
+      && index.isFresh(fileSize(options.binFileName), in.count());
+   if (indexed) {
+      // Индекс от прежнего содержимого файла того же размера не отличить по
+      // заголовку, поэтому найденные записи сверяются с искомым num.
+      for (auto& entry : found) {
+         for (uint64_t record : index.find(entry.first)) {
+            employee person;
+            if (record >= in.count()) {
+               indexed = false;
+               break;
+            }
+            in.read(record, 1, &person);
+            indexed = indexed && person.num == entry.first;
+            entry.second.push_back(person);
+         }
+      }
+      if (!indexed) {
+         std::cout << "Warning: index " << indexFileName(options.binFileName)
+                   << " does not match the file, scanning the whole file\n";
+         for (auto& entry : found) {
+            entry.second.clear();
+         }
+      }
+   }
+   else if (in.format() == EmployeeFormat::LEGACY) {
+      std::cout << "Warning: index " << indexFileName(options.binFileName)
+                << " is missing or stale, scanning the whole file\n";
+   }
+   if (!indexed) {
+      // В колоночном файле и архиве читаются только блоки, диапазон num
+      // которых содержит хотя бы один искомый номер.
+      std::vector<int> sortedIds = ids;
+      std::sort(sortedIds.begin(), sortedIds.end());
+      constexpr size_t BATCH = 4096;
+      std::vector<employee> batch(BATCH);
+      for (size_t b = 0; b < in.blockCount(); b++) {
+         EmployeeBlock block = in.block(b);
+         auto candidate = std::lower_bound(sortedIds.begin(), sortedIds.end(), block.minNum);
+         if (candidate == sortedIds.end() || *candidate > block.maxNum) {
+            continue;
+         }
+         for (uint64_t first = block.first; first < block.first + block.count; first += BATCH) {
+            size_t n = static_cast<size_t>(std::min<uint64_t>(BATCH, block.first + block.count - first));
+            in.read(first, n, batch.data());
+            for (size_t i = 0; i < n; i++) {
+               auto match = found.find(batch[i].num);
+               if (match != found.end()) {
+                  match->second.push_back(batch[i]);
+               }
+            }
+         }
+      }
+   }
+
+   for (int id : ids) {
+      const std::vector<employee>& rows = found[id];
+      if (rows.empty()) {
+         std::cout << "Employee " << id << " not found\n";
+      }
+      for (const employee& person : rows) {
+         writer(person);
+      }
+   }
+
+   if (reportDamage(in, options.binFileName)) {
+      return -1;
+   }
+   if (!flushReport(writer, options)) {
+      return -1;
+   }
+   return static_cast<long long>(writer.rowCount());
+}
+
+// Передаёт writer целые записи из начала buffer, а оставшуюся неполную
+// переносит в начало. Возвращает число оставшихся байт.
+size_t reportWholeRecords(char* buffer, size_t filled, ReportWriter& writer) {
+   size_t whole = filled / sizeof(employee) * sizeof(employee);
+   for (size_t offset = 0; offset < whole; offset += sizeof(employee)) {
+      employee person;
+      std::memcpy(&person, buffer + offset, sizeof(employee));
+      writer(person);
+   }
+   std::memmove(buffer, buffer + whole, filled - whole);
+   return filled - whole;
+}
+
+// Записи приходят через стандартный ввод (конвейер Main): каждая порция
+// форматируется и дописывается в отчёт сразу, неполная запись в конце
+// порции ждёт следующего чтения.
+long long writePipeReport(const ReporterOptions& options) {
+   OutputFile out;
+   if (!out.open(options.reportFileName)) {
+      std::cout << "Error: cannot open file " << options.reportFileName << " for writing\n";
+      return -1;
+   }
+   ReportWriter writer(out, options.xPerHour, options.format, options.rates.get(), options.exactMoney);
+   writer.writeHeader(options.label);
+   if (!flushReport(writer, options)) {
+      return -1;
+   }
+
+   std::vector<char> buffer(RECORDS_PER_CHUNK * sizeof(employee));
+   size_t filled = 0;
+   while (true) {
+      long long got = readSome(standardInput(), buffer.data() + filled, buffer.size() - filled);
+      if (got < 0) {
+         std::cout << "Error: cannot read standard input\n";
+         return -1;
+      }
+      if (got == 0) {
+         break;
+      }
+      filled = reportWholeRecords(buffer.data(), filled + static_cast<size_t>(got), writer);
+      if (!flushReport(writer, options)) {
+         return -1;
+      }
+   }
+   return static_cast<long long>(writer.rowCount());
+}
+
+// Отчёт, который растёт вместе с файлом (--follow): сначала строки по уже
+// записанным записям, затем после каждого дописывания - по новым целым
+// записям; неполная запись в конце ждёт своего продолжения. Строки
+// сбрасываются в отчёт сразу. Работа заканчивается, когда файл удалён
+// или переименован. Файл, усечённый на месте (короче уже прочитанного),
+// - ошибка: строки отчёта по стёртым записям уже не отозвать. Только
+// исходный формат.
+long long writeFollowReport(const ReporterOptions& options) {
+   NativeHandle in = openForReading(options.binFileName);
+   if (in == NO_HANDLE) {
+      std::cout << "Error: cannot open file " << options.binFileName << " for reading\n";
+      return -1;
+   }
+   FileWatcher watcher;
+   if (!watcher.open(options.binFileName, in)) {
+      std::cout << "Warning: cannot watch file " << options.binFileName << ", polling it instead\n";
+   }
+
+   OutputFile out;
+   if (!out.open(options.reportFileName)) {
+      std::cout << "Error: cannot open file " << options.reportFileName << " for writing\n";
+      closeHandle(in);
+      return -1;
+   }
+   ReportWriter writer(out, options.xPerHour, options.format, options.rates.get(), options.exactMoney);
+   writer.writeHeader(options.label);
+
+   std::vector<char> buffer(RECORDS_PER_CHUNK * sizeof(employee));
+   size_t filled = 0;
+   uint64_t processed = 0;
+   bool ok = true;
+   bool gone = false;
+   while (ok) {
+      // Всё, что уже дописано; конец файла - не конец отчёта.
+      long long got;
+      while ((got = readSome(in, buffer.data() + filled, buffer.size() - filled)) > 0) {
+         processed += static_cast<uint64_t>(got);
+         filled = reportWholeRecords(buffer.data(), filled + static_cast<size_t>(got), writer);
+      }
+      uint64_t size;
+      if (got == 0 && handleSize(in, size) && size < processed) {
+         std::cout << "Error: file " << options.binFileName << " was truncated while following it\n";
+         ok = false;
+      }
+      else if (got < 0) {
+         std::cout << "Error: cannot read file " << options.binFileName << "\n";
+         ok = false;
+      }
+      else if (!flushReport(writer, options)) {
+         ok = false;
+      }
+      if (!ok || gone) {
+         break;
+      }
+
+      WatchEvent event = watcher.wait();
+      if (event == WatchEvent::FAILED) {
+         std::cout << "Error: cannot watch file " << options.binFileName << "\n";
+         ok = false;
+      }
+      // Дочитываем то, что успели дописать до удаления.
+      gone = event == WatchEvent::GONE;
+   }
+   closeHandle(in);
+   if (ok && filled > 0) {
+      std::cout << "Warning: " << filled << " trailing bytes of " << options.binFileName
+                << " do not form a whole record\n";
+   }
+   return ok ? static_cast<long long>(writer.rowCount()) : -1;
+}
+
+long long generateReport(const ReporterOptions& requested) {
+   ReporterOptions options = requested;
+   if (options.label.empty()) {
+      options.label = options.binFileName;
+   }
+   if (!options.rateFileName.empty() && options.rates == nullptr) {
+      auto rates = std::make_shared<RateTable>();
+      if (!rates->load(options.rateFileName)) {
+         std::cout << "Error: " << rates->error() << "\n";
+         return -1;
+      }
+      if (options.incremental) {
+         // Контрольная точка хранит только общую ставку.
+         std::cout << "Error: --rates cannot be combined with --incremental\n";
+         return -1;
+      }
+      options.rates = std::move(rates);
+   }
+
+   EmployeeFile probe;
+   bool legacy = !probe.open(options.binFileName) || probe.format() == EmployeeFormat::LEGACY;
+   probe.close();
+
+   if (!options.extraBinFileNames.empty()) {
+      if (options.binFileName == "-" || !options.lookupList.empty() || options.summary
+         || options.sortKey != SortKey::NONE || options.incremental || options.follow) {
+         std::cout << "Error: several binary files can only be concatenated or merged (--merge)\n";
+         return -1;
+      }
+      if (options.ioMethod != IoMethod::DEFAULT) {
+         std::cout << "Error: --io and --direct read a single binary file\n";
+         return -1;
+      }
+      if (requested.label.empty()) {
+         options.label = options.binFileName;
+         for (const std::string& name : options.extraBinFileNames) {
+            options.label += ", " + name;
+         }
+      }
+      return writeMultiFileReport(options);
+   }
+   // Блоками читается только простой отчёт по файлу исходного формата; в
+   // остальных режимах --io и --direct не молчат, а предупреждают.
+   bool blockRead = legacy && options.binFileName != "-" && !options.follow && options.lookupList.empty()
+      && !options.summary && options.sortKey == SortKey::NONE && !options.incremental;
+   if (options.ioMethod != IoMethod::DEFAULT && !blockRead) {
+      std::cout << "Warning: --io and --direct only apply to plain reports of files in the original format,"
+                << " reading " << options.binFileName << " as usual\n";
+   }
+   if (options.follow) {
+      if (options.binFileName == "-" || !options.lookupList.empty() || options.summary
+         || options.sortKey != SortKey::NONE || options.incremental || !legacy) {
+         std::cout << "Error: --follow reports rows of one file in the original format\n";
+         return -1;
+      }
+      return writeFollowReport(options);
+   }
+   if (options.binFileName == "-") {
+      return writePipeReport(options);
+   }
+   if (!options.lookupList.empty()) {
+      return writeLookupReport(options);
+   }
+   if (options.summary) {
+      return writeSummaryReport(options);
+   }
+   if (options.sortKey != SortKey::NONE) {
+      return writeSortedReport(options);
+   }
+   if (options.incremental) {
+      return writeIncrementalReport(options);
+   }
+   if (options.ioMethod != IoMethod::DEFAULT && legacy) {
+      return writeBlockReadReport(options);
+   }
+   // Файл с контрольными суммами проверяется потоками, которые форматируют отчёт.
+   bool checksummed = legacy && fileSize(checksumFileName(options.binFileName)) > 0;
+   if (options.useMapping || !legacy || options.format != ReportFormat::TEXT || checksummed || options.rates
+      || options.exactMoney) {
+      return writeMappedReport(options);
+   }
+   return writeStreamReport(options);
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include "cpu_features.h"
+
+#ifdef EMPLOYEE_X86
+#include <immintrin.h>
+#endif
+
+// Пакетное вычисление зарплат: salaries[i] = hours[i] * xPerHour.
+// Векторные варианты дают те же результаты, что и скалярный (одно
+// умножение IEEE на элемент), вариант выбирается по CPUID при старте.
+
+using SalaryKernel = void (*)(const double* hours, double* salaries, size_t count, double xPerHour);
+
+inline void computeSalariesScalar(const double* hours, double* salaries, size_t count, double xPerHour) {
+   for (size_t i = 0; i < count; i++) {
+      salaries[i] = hours[i] * xPerHour;
+   }
+}
+
+#ifdef EMPLOYEE_X86
+EMPLOYEE_TARGET("sse2")
+inline void computeSalariesSse2(const double* hours, double* salaries, size_t count, double xPerHour) {
+   __m128d rate = _mm_set1_pd(xPerHour);
+   size_t i = 0;
+   for (; i + 4 <= count; i += 4) {
+      __m128d a = _mm_loadu_pd(hours + i);
+      __m128d b = _mm_loadu_pd(hours + i + 2);
+      _mm_storeu_pd(salaries + i, _mm_mul_pd(a, rate));
+      _mm_storeu_pd(salaries + i + 2, _mm_mul_pd(b, rate));
+   }
+   computeSalariesScalar(hours + i, salaries + i, count - i, xPerHour);
+}
+
+EMPLOYEE_TARGET("avx2")
+inline void computeSalariesAvx2(const double* hours, double* salaries, size_t count, double xPerHour) {
+   __m256d rate = _mm256_set1_pd(xPerHour);
+   size_t i = 0;
+   for (; i + 8 <= count; i += 8) {
+      __m256d a = _mm256_loadu_pd(hours + i);
+      __m256d b = _mm256_loadu_pd(hours + i + 4);
+      _mm256_storeu_pd(salaries + i, _mm256_mul_pd(a, rate));
+      _mm256_storeu_pd(salaries + i + 4, _mm256_mul_pd(b, rate));
+   }
+   computeSalariesScalar(hours + i, salaries + i, count - i, xPerHour);
+}
+
+EMPLOYEE_TARGET("avx512f")
+inline void computeSalariesAvx512(const double* hours, double* salaries, size_t count, double xPerHour) {
+   __m512d rate = _mm512_set1_pd(xPerHour);
+   size_t i = 0;
+   for (; i + 16 <= count; i += 16) {
+      __m512d a = _mm512_loadu_pd(hours + i);
+      __m512d b = _mm512_loadu_pd(hours + i + 8);
+      _mm512_storeu_pd(salaries + i, _mm512_mul_pd(a, rate));
+      _mm512_storeu_pd(salaries + i + 8, _mm512_mul_pd(b, rate));
+   }
+   if (i < count) {
+      __mmask8 mask = static_cast<__mmask8>((1u << (count - i > 8 ? 8 : count - i)) - 1);
+      _mm512_mask_storeu_pd(salaries + i, mask, _mm512_mul_pd(_mm512_maskz_loadu_pd(mask, hours + i), rate));
+      i += 8;
+      if (i < count) {
+         mask = static_cast<__mmask8>((1u << (count - i)) - 1);
+         _mm512_mask_storeu_pd(salaries + i, mask, _mm512_mul_pd(_mm512_maskz_loadu_pd(mask, hours + i), rate));
+      }
+   }
+}
+#endif
+
+struct SalaryKernelInfo {
+   const char* name;
+   SalaryKernel kernel;
+};
+
+inline SalaryKernelInfo selectSalaryKernel(const CpuFeatures& features) {
+#ifdef EMPLOYEE_X86
+   if (features.avx512f) return { "avx512", computeSalariesAvx512 };
+   if (features.avx2) return { "avx2", computeSalariesAvx2 };
+   if (features.sse2) return { "sse2", computeSalariesSse2 };
+#else
+   (void)features;
+#endif
+   return { "scalar", computeSalariesScalar };
+}
+
+inline const SalaryKernelInfo& salaryKernel() {
+   static const SalaryKernelInfo kernel = selectSalaryKernel(cpuFeatures());
+   return kernel;
+}
+
+inline void computeSalaries(const double* hours, double* salaries, size_t count, double xPerHour) {
+   salaryKernel().kernel(hours, salaries, count, xPerHour);
+}
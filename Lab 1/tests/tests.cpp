@@ -0,0 +1,1069 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include "employee_io.h"
+#include "employee_file.h"
+#include "employee_index.h"
+#include "report_format.h"
+#include "bulk_input.h"
+#include "salary_kernel.h"
+#include "report_checkpoint.h"
+#include "aggregate_report.h"
+#include "console_dump.h"
+#include "crc32c.h"
+#include "employee_checksum.h"
+#include "money.h"
+#include "radix_sort.h"
+#include "file_watch.h"
+
+std::string readWholeFile(const std::string& fileName) {
+	std::ifstream in(fileName, std::ios::binary);
+	return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+employee makeEmployee(int num, const char* name, double hours) {
+	employee person = {};
+	person.num = num;
+	size_t length = std::min(std::strlen(name), sizeof(person.name) - 1);
+	std::memcpy(person.name, name, length);
+	person.name[length] = '\0';
+	person.hours = hours;
+	return person;
+}
+
+void writeLegacyFile(const std::string& fileName, const std::vector<employee>& people) {
+	std::ofstream out(fileName, std::ios::binary);
+	out.write(reinterpret_cast<const char*>(people.data()), people.size() * sizeof(employee));
+}
+
+std::string generate(ReporterOptions options) {
+	EXPECT_GE(generateReport(options), 0);
+	return readWholeFile(options.reportFileName);
+}
+
+TEST(ReportFormat, RowMatchesIostream) {
+	std::vector<employee> people = {
+		makeEmployee(1, "Anna", 8.0), makeEmployee(-25, "Bob", 7.125),
+		makeEmployee(123456789, "Alexandrov", 1234567.891), makeEmployee(0, "", 1e-7)
+	};
+
+	std::ostringstream expected;
+	std::string actual;
+	char row[REPORT_MAX_ROW_SIZE];
+	for (size_t i = 0; i < people.size(); i++) {
+		double salary = people[i].hours * 3.5;
+		expected << std::left << std::setw(15) << people[i].num
+			<< std::setw(15) << std::string(people[i].name, employeeNameLength(people[i]))
+			<< std::setw(15) << people[i].hours
+			<< std::setw(15) << std::fixed << std::setprecision(2) << salary << REPORT_NEWLINE;
+		actual.append(row, formatReportRow(row, people[i], salary, i == 0));
+	}
+
+	EXPECT_EQ(actual, expected.str());
+}
+
+TEST(ReportGeneration, MappedAndThreadedMatchStreamReport) {
+	CreatorOptions creator;
+	creator.fileName = "test_report.bin";
+	creator.count = 200000;
+	creator.source = CreatorSource::SYNTHETIC;
+	creator.seed = 7;
+	ASSERT_EQ(createEmployees(creator), 0);
+
+	ReporterOptions options;
+	options.binFileName = creator.fileName;
+	options.reportFileName = "test_report.txt";
+	options.xPerHour = 12.5;
+	std::string streamReport = generate(options);
+
+	options.useMapping = true;
+	EXPECT_EQ(generate(options), streamReport);
+	options.threads = 3;
+	EXPECT_EQ(generate(options), streamReport);
+}
+
+TEST(ExternalSort, SmallBudgetSortsStably) {
+	std::vector<employee> people;
+	for (int i = 0; i < 50000; i++) {
+		people.push_back(makeEmployee((i * 7919) % 1000, i % 2 ? "Odd" : "Even", i));
+	}
+	writeLegacyFile("test_sort.bin", people);
+
+	ReporterOptions options;
+	options.binFileName = "test_sort.bin";
+	options.reportFileName = "test_sort.txt";
+	options.xPerHour = 1.0;
+	options.sortKey = SortKey::NUM;
+	options.sortMemory = 64 << 10;
+	ASSERT_EQ(generateReport(options), 50000);
+
+	std::ifstream report(options.reportFileName);
+	std::string line;
+	std::getline(report, line);
+	std::getline(report, line);
+	int previousNum = -1;
+	double previousHours = -1.0;
+	while (std::getline(report, line)) {
+		std::istringstream row(line);
+		int num;
+		std::string name;
+		double hours;
+		row >> num >> name >> hours;
+		ASSERT_GE(num, previousNum);
+		if (num == previousNum) {
+			ASSERT_GT(hours, previousHours);
+		}
+		previousNum = num;
+		previousHours = hours;
+	}
+
+	// Оборванная серия - ошибка слияния, а не тихо укороченный результат.
+	writeLegacyFile("test_sort.run", std::vector<employee>(people.begin(), people.begin() + 3));
+	std::ofstream("test_sort.run", std::ios::binary | std::ios::app).write("abc", 3);
+	EmployeeLess less{ SortKey::NUM, 1.0, nullptr };
+	std::vector<employee> merged;
+	auto sink = [&merged](const employee& person) { merged.push_back(person); };
+	EXPECT_FALSE(mergeRuns({ "test_sort.run" }, 2, less, sink));
+	EXPECT_EQ(merged.size(), 2u);
+}
+
+TEST(Arguments, InvalidNumbersAreRejectedWithoutExceptions) {
+	auto parseReporter = [](std::vector<std::string> args) {
+		std::vector<char*> argv;
+		for (std::string& arg : args) {
+			argv.push_back(&arg[0]);
+		}
+		ReporterOptions options;
+		return parseReporterArguments(static_cast<int>(argv.size()), argv.data(), options);
+	};
+	EXPECT_TRUE(parseReporter({ "Reporter", "--threads", "4", "--top", "3", "--mem", "64M", "in.bin", "out.txt", "2.5" }));
+	EXPECT_FALSE(parseReporter({ "Reporter", "--threads", "four", "in.bin", "out.txt", "2.5" }));
+	EXPECT_FALSE(parseReporter({ "Reporter", "--top", "99999999999", "in.bin", "out.txt", "2.5" }));
+	EXPECT_FALSE(parseReporter({ "Reporter", "--mem", "lots", "in.bin", "out.txt", "2.5" }));
+	EXPECT_FALSE(parseReporter({ "Reporter", "in.bin", "out.txt", "2.5x" }));
+
+	size_t bytes = 0;
+	EXPECT_TRUE(parseMemorySize("2G", bytes));
+	EXPECT_EQ(bytes, size_t(2) << 30);
+	EXPECT_FALSE(parseMemorySize("", bytes));
+	EXPECT_FALSE(parseMemorySize("12KB", bytes));
+	EXPECT_FALSE(parseMemorySize("99999999999999999999", bytes));
+
+	std::vector<std::string> args = { "Creator", "--threads", "x", "out.bin", "10" };
+	std::vector<char*> argv;
+	for (std::string& arg : args) {
+		argv.push_back(&arg[0]);
+	}
+	CreatorOptions creator;
+	EXPECT_FALSE(parseCreatorArguments(static_cast<int>(argv.size()), argv.data(), creator));
+}
+
+TEST(ColumnarFormat, ReadsBackSameRecordsAndReport) {
+	CreatorOptions creator;
+	creator.count = 70000;
+	creator.source = CreatorSource::SYNTHETIC;
+	creator.seed = 3;
+	creator.fileName = "test_legacy.bin";
+	ASSERT_EQ(createEmployees(creator), 0);
+	creator.fileName = "test_columnar.bin";
+	creator.format = EmployeeFormat::COLUMNAR;
+	ASSERT_EQ(createEmployees(creator), 0);
+
+	EmployeeFile legacy, columnar;
+	ASSERT_TRUE(legacy.open("test_legacy.bin"));
+	ASSERT_TRUE(columnar.open("test_columnar.bin"));
+	EXPECT_FALSE(legacy.isColumnar());
+	ASSERT_TRUE(columnar.isColumnar());
+	ASSERT_EQ(columnar.count(), legacy.count());
+	EXPECT_EQ(columnar.columns().blockCount(), 2u);
+
+	ReporterOptions options;
+	options.xPerHour = 2.0;
+	options.label = "same";
+	options.binFileName = "test_legacy.bin";
+	options.reportFileName = "test_legacy.txt";
+	std::string legacyReport = generate(options);
+	options.binFileName = "test_columnar.bin";
+	options.reportFileName = "test_columnar.txt";
+	EXPECT_EQ(generate(options), legacyReport);
+	columnar.close();
+
+	// Блоки за пределами данных или не сходящиеся с recordCount отвергаются.
+	std::string bytes = readWholeFile("test_columnar.bin");
+	ColumnarView view;
+	ASSERT_TRUE(view.attach(bytes.data(), bytes.size()));
+	ColumnarHeader header;
+	std::memcpy(&header, bytes.data(), sizeof(header));
+	std::string broken = bytes;
+	reinterpret_cast<ColumnarHeader*>(&broken[0])->recordCount = header.recordCount + 1;
+	EXPECT_FALSE(view.attach(broken.data(), broken.size()));
+	broken = bytes;
+	reinterpret_cast<ColumnarBlockInfo*>(&broken[header.indexOffset])->count = header.blockRecords + 1;
+	EXPECT_FALSE(view.attach(broken.data(), broken.size()));
+	broken = bytes;
+	reinterpret_cast<ColumnarBlockInfo*>(&broken[header.indexOffset + sizeof(ColumnarBlockInfo)])->offset = header.indexOffset - 8;
+	EXPECT_FALSE(view.attach(broken.data(), broken.size()));
+}
+
+TEST(EmployeeIndex, FindsRecordsAndDetectsStaleFile) {
+	std::vector<employee> people = {
+		makeEmployee(30, "C", 1), makeEmployee(10, "A", 2), makeEmployee(20, "B", 3), makeEmployee(10, "D", 4)
+	};
+	EmployeeWriter writer;
+	ASSERT_TRUE(writer.open("test_index.bin", EmployeeFormat::LEGACY, true));
+	for (const employee& person : people) {
+		writer.write(person);
+	}
+	ASSERT_TRUE(writer.close());
+
+	EmployeeIndex index;
+	ASSERT_TRUE(index.open("test_index.bin"));
+	EXPECT_TRUE(index.isFresh(fileSize("test_index.bin"), people.size()));
+	EXPECT_EQ(index.find(10), (std::vector<uint64_t>{ 1, 3 }));
+	EXPECT_EQ(index.find(30), (std::vector<uint64_t>{ 0 }));
+	EXPECT_TRUE(index.find(15).empty());
+
+	std::ofstream append("test_index.bin", std::ios::binary | std::ios::app);
+	append.write(reinterpret_cast<const char*>(&people[0]), sizeof(employee));
+	append.close();
+	EXPECT_FALSE(index.isFresh(fileSize("test_index.bin"), people.size() + 1));
+
+	// Файл переписан другой программой того же размера: индекс с виду свежий.
+	ASSERT_TRUE(writer.open("test_index.bin", EmployeeFormat::LEGACY, true));
+	writer.write(makeEmployee(5, "Alice", 1));
+	writer.write(makeEmployee(7, "Bob", 2));
+	ASSERT_TRUE(writer.close());
+	writeLegacyFile("test_index.bin", { makeEmployee(7, "Carl", 3), makeEmployee(9, "Dan", 4) });
+	ReporterOptions options;
+	options.binFileName = "test_index.bin";
+	options.reportFileName = "test_index.txt";
+	options.xPerHour = 1.0;
+	options.lookupList = "7,9";
+	std::string report = generate(options);
+	EXPECT_NE(report.find("Carl"), std::string::npos);
+	EXPECT_NE(report.find("Dan"), std::string::npos);
+	EXPECT_EQ(report.find("Bob"), std::string::npos);
+
+	// Без --index старый индекс удаляется.
+	ASSERT_TRUE(writer.open("test_index.bin", EmployeeFormat::LEGACY));
+	ASSERT_TRUE(writer.close());
+	EXPECT_EQ(fileSize(indexFileName("test_index.bin")), 0u);
+}
+
+TEST(BulkInput, ParsesCsvLines) {
+	std::FILE* csvFile = std::tmpfile();
+	ASSERT_NE(csvFile, nullptr);
+	std::fputs("1,Anna,8.5\r\n\n2,Alexandra,40\n3,C,1e2", csvFile);
+	std::rewind(csvFile);
+
+	CsvEmployeeReader reader(csvFile);
+	employee person;
+	ASSERT_TRUE(reader.next(person));
+	EXPECT_EQ(person.num, 1);
+	EXPECT_STREQ(person.name, "Anna");
+	EXPECT_DOUBLE_EQ(person.hours, 8.5);
+	ASSERT_TRUE(reader.next(person));
+	EXPECT_STREQ(person.name, "Alexandra");
+	ASSERT_TRUE(reader.next(person));
+	EXPECT_DOUBLE_EQ(person.hours, 100.0);
+	EXPECT_FALSE(reader.next(person));
+	EXPECT_TRUE(reader.error().empty());
+	std::fclose(csvFile);
+
+	// Имя длиннее 9 символов не обрезается, а отвергается с номером строки.
+	csvFile = std::tmpfile();
+	ASSERT_NE(csvFile, nullptr);
+	std::fputs("1,Anna,8.5\n\n2,Alexandrovich,40\n", csvFile);
+	std::rewind(csvFile);
+	CsvEmployeeReader longNames(csvFile);
+	ASSERT_TRUE(longNames.next(person));
+	EXPECT_FALSE(longNames.next(person));
+	EXPECT_EQ(longNames.error(), "name longer than 9 characters on CSV line 3");
+	std::fclose(csvFile);
+}
+
+TEST(SalaryKernel, DispatchedKernelMatchesScalar) {
+	std::vector<double> hours(1003);
+	for (size_t i = 0; i < hours.size(); i++) {
+		hours[i] = i * 0.37;
+	}
+	std::vector<double> expected(hours.size()), actual(hours.size());
+	computeSalariesScalar(hours.data(), expected.data(), hours.size(), 11.3);
+	computeSalaries(hours.data(), actual.data(), hours.size(), 11.3);
+	EXPECT_EQ(actual, expected);
+}
+
+TEST(ArchiveFormat, RoundTripsRecordsAndLooksUpByBlock) {
+	std::vector<employee> people;
+	for (int i = 0; i < 40000; i++) {
+		double hours = i % 7 == 0 ? i / 3.0 : (i % 400) * 0.25;
+		people.push_back(makeEmployee(1000 + i + (i % 5 == 0 ? 3 : 0), i % 3 ? "Petrov" : "Ivanova", hours));
+	}
+	people.push_back(makeEmployee(-7, "", -1.5));
+	EmployeeWriter writer;
+	ASSERT_TRUE(writer.open("test_archive.bin", EmployeeFormat::ARCHIVE));
+	for (const employee& person : people) {
+		writer.write(person);
+	}
+	ASSERT_TRUE(writer.close());
+	writeLegacyFile("test_archive_legacy.bin", people);
+	EXPECT_LT(fileSize("test_archive.bin") * 4, fileSize("test_archive_legacy.bin"));
+
+	EmployeeFile archive;
+	ASSERT_TRUE(archive.open("test_archive.bin"));
+	ASSERT_TRUE(archive.isArchive());
+	ASSERT_EQ(archive.count(), people.size());
+	std::vector<employee> restored(people.size());
+	archive.read(0, restored.size(), restored.data());
+	for (size_t i = 0; i < people.size(); i++) {
+		ASSERT_EQ(restored[i].num, people[i].num);
+		ASSERT_STREQ(restored[i].name, people[i].name);
+		ASSERT_EQ(restored[i].hours, people[i].hours);
+	}
+
+	ReporterOptions options;
+	options.xPerHour = 3.0;
+	options.label = "same";
+	options.binFileName = "test_archive_legacy.bin";
+	options.reportFileName = "test_archive_legacy.txt";
+	std::string legacyReport = generate(options);
+	options.binFileName = "test_archive.bin";
+	options.reportFileName = "test_archive.txt";
+	options.threads = 2;
+	EXPECT_EQ(generate(options), legacyReport);
+
+	// 1003 встречается дважды (i = 0 и i = 3), 41003 нет.
+	options.lookupList = "1003,41003,-7";
+	EXPECT_EQ(generateReport(options), 3);
+	archive.close();
+
+	// Заголовок и индекс блоков, не согласованные друг с другом, отвергаются.
+	std::string bytes = readWholeFile("test_archive.bin");
+	ArchiveView view;
+	ASSERT_TRUE(view.attach(bytes.data(), bytes.size()));
+	ArchiveHeader header;
+	std::memcpy(&header, bytes.data(), sizeof(header));
+	std::string broken = bytes;
+	reinterpret_cast<ArchiveHeader*>(&broken[0])->recordCount = header.recordCount + 1;
+	EXPECT_FALSE(view.attach(broken.data(), broken.size()));
+	broken = bytes;
+	reinterpret_cast<ArchiveBlockInfo*>(&broken[header.indexOffset])->count = 0;
+	EXPECT_FALSE(view.attach(broken.data(), broken.size()));
+	broken = bytes;
+	reinterpret_cast<ArchiveBlockInfo*>(&broken[header.indexOffset])->offset = header.dictionaryOffset;
+	EXPECT_FALSE(view.attach(broken.data(), broken.size()));
+
+	// Испорченные данные блока - ошибка, а не строки с нулями.
+	ArchiveBlockInfo second;
+	std::memcpy(&second, bytes.data() + header.indexOffset + sizeof(ArchiveBlockInfo), sizeof(second));
+	for (uint32_t i = 0; i < second.compressedSize; i += 7) {
+		bytes[second.offset + i] = static_cast<char>(bytes[second.offset + i] ^ 0x5A);
+	}
+	std::ofstream("test_archive.bin", std::ios::binary).write(bytes.data(), bytes.size());
+	options.lookupList.clear();
+	EXPECT_EQ(generateReport(options), -1);
+	options.summary = true;
+	EXPECT_EQ(generateReport(options), -1);
+}
+
+TEST(IncrementalReport, AppendsOnlyNewRecords) {
+	std::vector<employee> people;
+	for (int i = 0; i < 1000; i++) {
+		people.push_back(makeEmployee(i, "Inc", i * 0.5));
+	}
+	writeLegacyFile("test_incremental.bin", people);
+	std::remove("test_incremental.txt.ckpt");
+
+	ReporterOptions options;
+	options.binFileName = "test_incremental.bin";
+	options.reportFileName = "test_incremental.txt";
+	options.xPerHour = 4.0;
+	options.incremental = true;
+	ASSERT_EQ(generateReport(options), 1000);
+
+	std::ofstream append("test_incremental.bin", std::ios::binary | std::ios::app);
+	for (int i = 1000; i < 1500; i++) {
+		employee person = makeEmployee(i, "New", i * 0.25);
+		append.write(reinterpret_cast<const char*>(&person), sizeof(employee));
+	}
+	append.close();
+	ASSERT_EQ(generateReport(options), 500);
+	EXPECT_EQ(generateReport(options), 0);
+
+	ReporterOptions full = options;
+	full.incremental = false;
+	full.reportFileName = "test_incremental_full.txt";
+	EXPECT_EQ(readWholeFile(options.reportFileName), generate(full));
+
+	ReportCheckpoint checkpoint;
+	ASSERT_TRUE(readCheckpoint(options.reportFileName, checkpoint));
+	EXPECT_EQ(checkpoint.recordCount, 1500u);
+
+	// Другая ставка - отчёт строится заново.
+	options.xPerHour = 5.0;
+	full.xPerHour = 5.0;
+	EXPECT_EQ(generateReport(options), 1500);
+	EXPECT_EQ(readWholeFile(options.reportFileName), generate(full));
+
+	// Переход на --exact тоже; итог в копейках хранится в контрольной точке.
+	options.exactMoney = true;
+	full.exactMoney = true;
+	EXPECT_EQ(generateReport(options), 1500);
+	EXPECT_EQ(readWholeFile(options.reportFileName), generate(full));
+	ASSERT_TRUE(readCheckpoint(options.reportFileName, checkpoint));
+	EXPECT_EQ(checkpoint.exactMoney, 1u);
+	EXPECT_EQ(checkpoint.totalCents, 202968750);
+	EXPECT_EQ(generateReport(options), 0);
+}
+
+TEST(AggregateReport, TopEarnersAndQuantilesMatchExact) {
+	std::vector<employee> people;
+	for (int i = 0; i < 200000; i++) {
+		people.push_back(makeEmployee(i, "Agg", (i * 7919) % 100000 * 0.01 + 0.5));
+	}
+	writeLegacyFile("test_aggregate.bin", people);
+
+	std::vector<double> hours;
+	for (const employee& person : people) {
+		hours.push_back(person.hours);
+	}
+	std::sort(hours.begin(), hours.end());
+
+	EmployeeFile file;
+	ASSERT_TRUE(file.open("test_aggregate.bin"));
+	EmployeeAggregate single(5), split(5), second(5);
+	aggregateRange(file, 0, people.size(), 2.0, single);
+	aggregateRange(file, 0, 70000, 2.0, split);
+	aggregateRange(file, 70000, people.size(), 2.0, second);
+	split.merge(second);
+
+	for (const EmployeeAggregate* aggregate : { &single, &split }) {
+		EXPECT_EQ(aggregate->count, people.size());
+		std::vector<TopEarner> top = aggregate->top.sorted();
+		ASSERT_EQ(top.size(), 5u);
+		EXPECT_DOUBLE_EQ(top[0].salary, hours.back() * 2.0);
+		EXPECT_GE(top[0].salary, top[4].salary);
+		for (double q : { 0.5, 0.9, 0.99 }) {
+			double exact = hours[static_cast<size_t>(q * (hours.size() - 1))];
+			EXPECT_NEAR(aggregate->hours.quantile(q), exact, exact * QuantileSketch::QUANTILE_ACCURACY * 1.01);
+		}
+	}
+
+	ReporterOptions options;
+	options.binFileName = "test_aggregate.bin";
+	options.reportFileName = "test_aggregate.txt";
+	options.xPerHour = 2.0;
+	options.topCount = 3;
+	options.summary = true;
+	std::string oneThread = generate(options);
+	EXPECT_NE(oneThread.find("P99 hours"), std::string::npos);
+	EXPECT_NE(oneThread.find("Top 3 earners"), std::string::npos);
+	options.threads = 3;
+	EXPECT_EQ(generate(options), oneThread);
+
+	// NaN и бесконечные часы не ломают скетч и кучу лучших.
+	QuantileSketch sketch;
+	for (double value : { std::nan(""), HUGE_VAL, -HUGE_VAL, 2.0, 4.0 }) {
+		sketch.add(value);
+	}
+	EXPECT_EQ(sketch.count(), 2u);
+	EXPECT_EQ(sketch.nonFinite(), 3u);
+	EXPECT_NEAR(sketch.quantile(1.0), 4.0, 4.0 * QuantileSketch::QUANTILE_ACCURACY);
+	people[1].hours = std::nan("");
+	people[2].hours = HUGE_VAL;
+	people[3].hours = -HUGE_VAL;
+	writeLegacyFile("test_aggregate.bin", people);
+	std::string summary = generate(options);
+	EXPECT_NE(summary.find("P99 hours"), std::string::npos);
+	options.threads = 1;
+	EXPECT_EQ(generate(options), summary);
+}
+
+TEST(ReportFormat, MachineReadableFormats) {
+	std::vector<employee> people = {
+		makeEmployee(1, "Anna", 8.5), makeEmployee(-2, "Q\"x,y", 0.1), makeEmployee(3, "Back\\s", 1e300)
+	};
+	writeLegacyFile("test_formats.bin", people);
+
+	ReporterOptions options;
+	options.binFileName = "test_formats.bin";
+	options.reportFileName = "test_formats.out";
+	options.xPerHour = 2.0;
+	options.format = ReportFormat::CSV;
+	std::string csv = generate(options);
+	EXPECT_EQ(csv.substr(0, csv.find("\n3,")),
+		"num,name,hours,salary\n1,Anna,8.5,17.00\n-2,\"Q\"\"x,y\",0.1,0.20");
+
+	options.format = ReportFormat::JSONL;
+	options.threads = 2;
+	std::string jsonl = generate(options);
+	EXPECT_EQ(jsonl.substr(0, jsonl.find('\n') + 1), "{\"num\":1,\"name\":\"Anna\",\"hours\":8.5,\"salary\":17.00}\n");
+	EXPECT_NE(jsonl.find("\"name\":\"Back\\\\s\",\"hours\":1e+300"), std::string::npos);
+
+	options.format = ReportFormat::BINARY;
+	options.sortKey = SortKey::NUM;
+	std::string binary = generate(options);
+	ASSERT_EQ(binary.size(), sizeof(BinaryReportHeader) + people.size() * BINARY_REPORT_ROW_SIZE);
+	int32_t firstNum;
+	double firstSalary;
+	std::memcpy(&firstNum, binary.data() + sizeof(BinaryReportHeader), sizeof(firstNum));
+	std::memcpy(&firstSalary, binary.data() + sizeof(BinaryReportHeader) + 22, sizeof(firstSalary));
+	EXPECT_EQ(firstNum, -2);
+	EXPECT_DOUBLE_EQ(firstSalary, 0.2);
+}
+
+TEST(BlockReader, PreadAndUringMatchStreamReport) {
+	CreatorOptions creator;
+	creator.fileName = "test_blocks.bin";
+	creator.count = 150001;
+	creator.source = CreatorSource::SYNTHETIC;
+	creator.seed = 11;
+	ASSERT_EQ(createEmployees(creator), 0);
+	// Неполная запись в конце файла не попадает в отчёт.
+	std::ofstream("test_blocks.bin", std::ios::binary | std::ios::app).write("abc", 3);
+
+	ReporterOptions options;
+	options.binFileName = creator.fileName;
+	options.reportFileName = "test_blocks.txt";
+	options.xPerHour = 1.5;
+	std::string streamReport = generate(options);
+	options.ioMethod = IoMethod::PREAD;
+	EXPECT_EQ(generate(options), streamReport);
+	options.ioMethod = IoMethod::URING;
+	EXPECT_EQ(generate(options), streamReport);
+	options.directIo = true;
+	EXPECT_EQ(generate(options), streamReport);
+	options.ioMethod = IoMethod::PREAD;
+	EXPECT_EQ(generate(options), streamReport);
+
+	// Колоночный файл блоками не читается: --direct лишь предупреждает.
+	creator.fileName = "test_blocks_columnar.bin";
+	creator.format = EmployeeFormat::COLUMNAR;
+	ASSERT_EQ(createEmployees(creator), 0);
+	options.binFileName = creator.fileName;
+	options.label = "test_blocks.bin";
+	EXPECT_EQ(generate(options), streamReport);
+}
+
+TEST(BlockReader, DirectReadsFileNotMultipleOfAlignment) {
+	for (size_t size : { READ_ALIGNMENT * 3 + 1, READ_BLOCK_SIZE * 2 + 100, READ_BLOCK_SIZE - 1 }) {
+		std::string bytes(size, '\0');
+		for (size_t i = 0; i < size; i++) {
+			bytes[i] = static_cast<char>(i * 131 + i / 4096);
+		}
+		std::ofstream("test_direct.bin", std::ios::binary | std::ios::trunc).write(bytes.data(), bytes.size());
+		for (IoMethod method : { IoMethod::PREAD, IoMethod::URING }) {
+			BlockReader reader;
+			ASSERT_TRUE(reader.open("test_direct.bin", method, true));
+			std::string read;
+			const char* data;
+			size_t got;
+			while (reader.next(data, got)) {
+				read.append(data, got);
+			}
+			EXPECT_FALSE(reader.error());
+			EXPECT_TRUE(read == bytes) << "size " << size;
+		}
+	}
+}
+
+TEST(ConsoleDump, ListingMatchesIostreamAndPages) {
+	std::vector<employee> people;
+	std::ostringstream expected;
+	expected << "\n\tBinary file content:\n" << std::left << std::setw(15) << "Employee ID"
+		<< std::setw(15) << "Employee name" << std::setw(15) << "Employee hours\n";
+	for (int i = 0; i < 1000; i++) {
+		people.push_back(makeEmployee(i * 37 - 500, i % 2 ? "Alexandrov" : "Li", i * 1.37));
+		expected << std::setw(15) << people.back().num
+			<< std::setw(15) << std::string(people.back().name, employeeNameLength(people.back()))
+			<< std::setw(15) << people.back().hours << "\n";
+	}
+	writeLegacyFile("test_dump.bin", people);
+
+	OutputFile out;
+	ASSERT_TRUE(out.open("test_dump.txt"));
+	ASSERT_TRUE(dumpBinFile("test_dump.bin", DumpRange(), out));
+	out.close();
+	std::string listing = readWholeFile("test_dump.txt");
+	EXPECT_EQ(listing, expected.str());
+
+	std::ofstream("test_dump_lines.txt") << "a\nb\nc\nd\ne\n";
+	DumpRange range;
+	range.head = 1;
+	range.tail = 2;
+	ASSERT_TRUE(out.open("test_dump.txt"));
+	ASSERT_TRUE(dumpTextFile("test_dump_lines.txt", range, out));
+	out.close();
+	EXPECT_EQ(readWholeFile("test_dump.txt"), "a\n...\nd\ne\n");
+
+	range.head = 0;
+	range.tail = 3;
+	ASSERT_TRUE(out.open("test_dump.txt"));
+	ASSERT_TRUE(dumpBinFile("test_dump.bin", range, out));
+	out.close();
+	std::string tail = readWholeFile("test_dump.txt");
+	std::string tailRows = tail.substr(tail.find("...\n") + 4);
+	EXPECT_EQ(std::count(tailRows.begin(), tailRows.end(), '\n'), 3);
+	EXPECT_EQ(listing.substr(listing.size() - tailRows.size()), tailRows);
+}
+
+TEST(Checksum, KernelsMatchAndCorruptionIsDetected) {
+	const char check[] = "123456789";
+	EXPECT_EQ(crc32c(check, 9), 0xE3069283u);
+	std::string data(100003, '\0');
+	for (size_t i = 0; i < data.size(); i++) {
+		data[i] = static_cast<char>(i * 131 + (i >> 7));
+	}
+	uint32_t expected = ~crc32cTable(~0u, data.data(), data.size());
+	EXPECT_EQ(crc32c(data.data(), data.size()), expected);
+	EXPECT_EQ(crc32c(data.data() + 1000, data.size() - 1000, crc32c(data.data(), 1000)), expected);
+
+	CreatorOptions creator;
+	creator.fileName = "test_crc.bin";
+	creator.count = 3 * CHECKSUM_BLOCK_RECORDS + 17;
+	creator.source = CreatorSource::SYNTHETIC;
+	creator.seed = 5;
+	creator.checksum = true;
+	ASSERT_EQ(createEmployees(creator), 0);
+
+	ReporterOptions options;
+	options.binFileName = creator.fileName;
+	options.reportFileName = "test_crc.txt";
+	options.xPerHour = 2.0;
+	options.threads = 2;
+	std::string report = generate(options);
+	options.threads = 1;
+	options.ioMethod = IoMethod::PREAD;
+	EXPECT_EQ(generate(options), report);
+
+	// Один испорченный байт во втором блоке.
+	{
+		std::fstream file("test_crc.bin", std::ios::binary | std::ios::in | std::ios::out);
+		file.seekp((CHECKSUM_BLOCK_RECORDS + 5) * sizeof(employee) + offsetof(employee, hours));
+		file.put('\x7f');
+	}
+	EXPECT_EQ(generateReport(options), -1);
+	// Строки испорченного блока и следующих не пишутся.
+	EXPECT_LT(readWholeFile(options.reportFileName).size(), report.size() / 2);
+	options.ioMethod = IoMethod::DEFAULT;
+	EXPECT_EQ(generateReport(options), -1);
+	options.threads = 2;
+	EXPECT_EQ(generateReport(options), -1);
+
+	// Файл того же размера без --checksum: старые суммы удаляются.
+	creator.checksum = false;
+	creator.seed = 6;
+	ASSERT_EQ(createEmployees(creator), 0);
+	EXPECT_EQ(fileSize(checksumFileName(creator.fileName)), 0u);
+	EXPECT_EQ(generateReport(options), static_cast<long long>(creator.count));
+	creator.threads = 2;
+	creator.checksum = true;
+	ASSERT_EQ(createEmployees(creator), 0);
+	creator.checksum = false;
+	ASSERT_EQ(createEmployees(creator), 0);
+	EXPECT_EQ(fileSize(checksumFileName(creator.fileName)), 0u);
+}
+
+TEST(MultiFileReport, ConcatenatesAndMergesByNumWithSubtotals) {
+	std::vector<employee> first, second;
+	for (int i = 0; i < 3000; i++) {
+		first.push_back(makeEmployee(i * 2, "First", i * 0.5));
+	}
+	for (int i = 0; i < 2000; i++) {
+		second.push_back(makeEmployee((i * 7919) % 5000, "Second", i * 0.25));
+	}
+	writeLegacyFile("test_multi_a.bin", first);
+	writeLegacyFile("test_multi_b.bin", second);
+
+	std::vector<employee> all = first;
+	all.insert(all.end(), second.begin(), second.end());
+	writeLegacyFile("test_multi_all.bin", all);
+	std::stable_sort(all.begin(), all.end(), [](const employee& a, const employee& b) { return a.num < b.num; });
+	writeLegacyFile("test_multi_sorted.bin", all);
+
+	ReporterOptions options;
+	options.binFileName = "test_multi_all.bin";
+	options.reportFileName = "test_multi.txt";
+	options.xPerHour = 3.0;
+	options.label = "test_multi_a.bin, test_multi_b.bin";
+	std::string concatenated = generate(options);
+	options.binFileName = "test_multi_sorted.bin";
+	std::string merged = generate(options);
+
+	options.binFileName = "test_multi_a.bin";
+	options.extraBinFileNames = { "test_multi_b.bin" };
+	options.label.clear();
+	options.threads = 2;
+	std::string report = generate(options);
+	ASSERT_EQ(report.substr(0, concatenated.size()), concatenated);
+	std::string subtotals = report.substr(concatenated.size());
+	EXPECT_EQ(subtotals.find("\tSubtotals:\n"), 0u);
+	EXPECT_NE(subtotals.find("3000           "), std::string::npos);
+	EXPECT_NE(subtotals.find("2000           "), std::string::npos);
+	EXPECT_NE(subtotals.find("5000           "), std::string::npos);
+
+	options.mergeByNum = true;
+	report = generate(options);
+	ASSERT_EQ(report.substr(0, merged.size()), merged);
+	EXPECT_EQ(report.substr(merged.size()), subtotals);
+
+	// Несколько файлов читаются только отображением: --io не молчит.
+	options.ioMethod = IoMethod::PREAD;
+	EXPECT_EQ(generateReport(options), -1);
+}
+
+// Запись другого вида (как Employee в Lab 5) описывается той же схемой.
+struct WideEmployee {
+	int num;
+	char name[31];
+	double hours;
+};
+
+using WideEmployeeSchema = RecordSchema<WideEmployee,
+	Field<&WideEmployee::num, 10>,
+	Field<&WideEmployee::name, 35>,
+	Field<&WideEmployee::hours, 10>>;
+
+TEST(RecordSchema, PacksFormatsAndAccessesFields) {
+	static_assert(WideEmployeeSchema::packedSize == 4 + 31 + 8);
+	static_assert(WideEmployeeSchema::fieldCount == 3);
+
+	WideEmployee person;
+	std::memset(&person, 0x5a, sizeof(person));
+	person.num = -17;
+	std::strcpy(person.name, "Konstantin");
+	person.hours = 12.345678;
+	EXPECT_EQ(WideEmployeeSchema::get<0>(person), -17);
+	WideEmployeeSchema::get<2>(person) += 1.0;
+
+	char packed[WideEmployeeSchema::packedSize];
+	EXPECT_EQ(WideEmployeeSchema::pack(person, packed), packed + sizeof(packed));
+	EXPECT_EQ(packed[4 + 10], '\0');
+	EXPECT_EQ(packed[4 + 30], '\0');
+	WideEmployee copy = {};
+	EXPECT_EQ(WideEmployeeSchema::unpack(copy, packed), packed + sizeof(packed));
+	EXPECT_EQ(copy.num, person.num);
+	EXPECT_STREQ(copy.name, person.name);
+	EXPECT_EQ(copy.hours, person.hours);
+
+	std::ostringstream expected;
+	expected << std::left << std::setw(10) << person.num << std::setw(35) << person.name
+		<< std::setw(10) << person.hours;
+	char row[WideEmployeeSchema::maxFormattedSize];
+	char* end = WideEmployeeSchema::format(person, row);
+	EXPECT_EQ(std::string(row, end), expected.str());
+
+	employee small = makeEmployee(7, "Ann", 1.5);
+	char binaryRow[BINARY_REPORT_ROW_SIZE];
+	EXPECT_EQ(formatBinaryRow(binaryRow, small, 3.0), binaryRow + 30);
+	employee back = {};
+	EmployeeSchema::unpack(back, binaryRow);
+	EXPECT_EQ(back.num, 7);
+	EXPECT_STREQ(back.name, "Ann");
+	EXPECT_EQ(back.hours, 1.5);
+}
+
+TEST(RateTable, JoinsRatesIntoReport) {
+	RateTable table;
+	for (int num = -5000; num < 5000; num++) {
+		table.insert(num * 7, num * 0.5);
+	}
+	table.insert(INT_MIN, 9.0);
+	table.insert(14, 100.0);
+	EXPECT_EQ(table.size(), 10001u);
+	EXPECT_EQ(table.rate(-35, 1.0), -2.5);
+	EXPECT_EQ(table.rate(14, 1.0), 100.0);
+	EXPECT_EQ(table.rate(INT_MIN, 1.0), 9.0);
+	EXPECT_EQ(table.rate(15, 1.25), 1.25);
+
+	std::ofstream("test_rates.txt") << "# num,rate\n2,10\n3 20.5\r\n\n5\t0.25\n2,30\n";
+	std::vector<employee> people;
+	for (int i = 0; i < 200000; i++) {
+		people.push_back(makeEmployee(i % 7, "Rated", 8.0 + i % 3));
+	}
+	writeLegacyFile("test_rates.bin", people);
+
+	std::string expected = formatReportHeader("test_rates.bin");
+	char row[REPORT_MAX_ROW_SIZE];
+	const double rates[] = { 1.5, 1.5, 30.0, 20.5, 1.5, 0.25, 1.5 };
+	for (size_t i = 0; i < people.size(); i++) {
+		expected.append(row, formatReportRow(row, people[i], people[i].hours * rates[people[i].num], i == 0));
+	}
+
+	ReporterOptions options;
+	options.binFileName = "test_rates.bin";
+	options.reportFileName = "test_rates_report.txt";
+	options.xPerHour = 1.5;
+	options.rateFileName = "test_rates.txt";
+	EXPECT_EQ(generate(options), expected);
+	options.threads = 2;
+	EXPECT_EQ(generate(options), expected);
+	options.ioMethod = IoMethod::PREAD;
+	EXPECT_EQ(generate(options), expected);
+
+	std::ofstream("test_rates.txt") << "1,2\n2,x\n";
+	EXPECT_EQ(generateReport(options), -1);
+}
+
+TEST(Money, FormatsCentsAndCountsExactly) {
+	EXPECT_EQ(decimalDigits(0), 1);
+	EXPECT_EQ(decimalDigits(9), 1);
+	EXPECT_EQ(decimalDigits(10), 2);
+	EXPECT_EQ(decimalDigits(99), 2);
+	EXPECT_EQ(decimalDigits(100), 3);
+	EXPECT_EQ(decimalDigits(UINT64_MAX), 20);
+	EXPECT_EQ(centsString(0), "0.00");
+	EXPECT_EQ(centsString(-5), "-0.05");
+	EXPECT_EQ(centsString(100), "1.00");
+	EXPECT_EQ(centsString(-123456789), "-1234567.89");
+	EXPECT_EQ(centsString(INT64_MIN), "-92233720368547758.08");
+	for (int64_t cents = -100000; cents <= 100000; cents += 7) {
+		char expected[32];
+		char* end = std::to_chars(expected, expected + sizeof(expected), cents / 100.0, std::chars_format::fixed, 2).ptr;
+		ASSERT_EQ(centsString(cents), std::string(expected, end));
+	}
+
+	EXPECT_EQ(toHundredths(0.1), 10);
+	EXPECT_EQ(toHundredths(-2.345), -235);
+	EXPECT_EQ(salaryCents(2.5, 333), 833);
+	EXPECT_EQ(salaryCents(-2.5, 333), -833);
+	EXPECT_EQ(salaryCents(0.1, 10), 1);
+	// Часы не округляются до сотых раньше произведения: 24.9375, а не 7.13 * 3.50.
+	EXPECT_EQ(salaryCents(7.125, 350), 2494);
+	EXPECT_EQ(salaryCents(-7.125, 350), -2494);
+	EXPECT_EQ(salaryCents(1e7, 1000000000), 10000000000000000);
+	EXPECT_EQ(salaryCents(1e7 + 1, 100), MONEY_INVALID);
+	EXPECT_EQ(salaryCents(std::nan(""), 100), MONEY_INVALID);
+	EXPECT_EQ(salaryCents(1.0, toHundredths(HUGE_VAL)), MONEY_INVALID);
+
+	std::vector<employee> people;
+	for (int i = 0; i < 100000; i++) {
+		people.push_back(makeEmployee(i, "Exact", 0.1 * (i % 10)));
+	}
+	writeLegacyFile("test_exact.bin", people);
+	std::string expected = formatReportHeader("test_exact.bin");
+	char row[REPORT_MAX_ROW_SIZE];
+	int64_t totalCents = 0;
+	for (size_t i = 0; i < people.size(); i++) {
+		int64_t cents = salaryCents(people[i].hours, 10);
+		totalCents += cents;
+		expected.append(row, formatReportRow(row, people[i], Money::fromCents(cents), i == 0));
+	}
+	EXPECT_EQ(totalCents, 450000);
+
+	ReporterOptions options;
+	options.binFileName = "test_exact.bin";
+	options.reportFileName = "test_exact_report.txt";
+	options.xPerHour = 0.1;
+	options.exactMoney = true;
+	EXPECT_EQ(generate(options), expected);
+	options.ioMethod = IoMethod::PREAD;
+	EXPECT_EQ(generate(options), expected);
+
+	options.summary = true;
+	std::string summary = generate(options);
+	EXPECT_NE(summary.find("Total salary   4500.00\n"), std::string::npos) << summary;
+
+	// Часы вне диапазона - ошибка отчёта в любом режиме.
+	people[5].hours = std::numeric_limits<double>::infinity();
+	writeLegacyFile("test_exact.bin", people);
+	EXPECT_EQ(generateReport(options), -1);
+	options.summary = false;
+	EXPECT_EQ(generateReport(options), -1);
+	options.ioMethod = IoMethod::DEFAULT;
+	EXPECT_EQ(generateReport(options), -1);
+	options.sortKey = SortKey::NUM;
+	EXPECT_EQ(generateReport(options), -1);
+}
+
+TEST(RadixSort, MatchesStableSortByName) {
+	const char* names[] = { "", "A", "Ab", "Abc", "Zed", "Anna", "Annabel", "Annabelle1", "annabelle2", "Bob" };
+	std::vector<employee> people;
+	for (int i = 0; i < 100000; i++) {
+		employee person = makeEmployee(i, names[(i * 7919) % 10], i % 100);
+		// Мусор после '\0' не должен влиять на порядок.
+		if (i % 3 == 0 && std::strlen(person.name) < 8) {
+			person.name[9] = static_cast<char>('a' + i % 26);
+		}
+		people.push_back(person);
+	}
+	writeLegacyFile("test_radix.bin", people);
+
+	std::vector<employee> sorted = people;
+	for (employee& person : sorted) {
+		normalizeName(person);
+	}
+	std::stable_sort(sorted.begin(), sorted.end(), EmployeeLess{ SortKey::NAME, 1.0 });
+	std::string expected = formatReportHeader("test_radix.bin");
+	char row[REPORT_MAX_ROW_SIZE];
+	for (size_t i = 0; i < sorted.size(); i++) {
+		expected.append(row, formatReportRow(row, sorted[i], sorted[i].hours, i == 0));
+	}
+
+	ReporterOptions options;
+	options.binFileName = "test_radix.bin";
+	options.reportFileName = "test_radix.txt";
+	options.xPerHour = 1.0;
+	options.sortKey = SortKey::NAME;
+	EXPECT_EQ(generate(options), expected);
+	options.threads = 3;
+	EXPECT_EQ(generate(options), expected);
+	// Ключи не помещаются - внешняя сортировка сравнениями.
+	options.sortMemory = 1 << 20;
+	EmployeeFile file;
+	ASSERT_TRUE(file.open("test_radix.bin"));
+	EXPECT_FALSE(fitsRadixSort(file, options.sortMemory));
+	EXPECT_EQ(generate(options), expected);
+}
+
+#ifdef __linux__
+TEST(FollowReport, ReportsAppendedRecordsUntilFileIsRemoved) {
+	std::vector<employee> people;
+	for (int i = 0; i < 1000; i++) {
+		people.push_back(makeEmployee(i, "Follow", i * 0.25));
+	}
+	const char* data = reinterpret_cast<const char*>(people.data());
+	writeLegacyFile("test_follow.bin", std::vector<employee>(people.begin(), people.begin() + 10));
+
+	auto rowsUpTo = [&](size_t records) {
+		std::string text = formatReportHeader("test_follow.bin");
+		char row[REPORT_MAX_ROW_SIZE];
+		for (size_t i = 0; i < records; i++) {
+			text.append(row, formatReportRow(row, people[i], people[i].hours * 2.0, i == 0));
+		}
+		return text;
+	};
+	std::string expected = rowsUpTo(people.size());
+	auto waitForReport = [](const std::string& text) {
+		for (int attempt = 0; attempt < 500 && readWholeFile("test_follow.txt") != text; attempt++) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+		return readWholeFile("test_follow.txt");
+	};
+
+	ReporterOptions options;
+	options.binFileName = "test_follow.bin";
+	options.reportFileName = "test_follow.txt";
+	options.xPerHour = 2.0;
+	options.follow = true;
+	long long reported = -1;
+	std::thread reporter([&] { reported = generateReport(options); });
+	EXPECT_EQ(waitForReport(rowsUpTo(10)), rowsUpTo(10));
+
+	// Запись, дописанная по частям, появляется в отчёте только целиком.
+	std::ofstream out("test_follow.bin", std::ios::binary | std::ios::app);
+	size_t written = 10 * sizeof(employee);
+	out.write(data + written, sizeof(employee) / 2).flush();
+	written += sizeof(employee) / 2;
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	EXPECT_EQ(readWholeFile("test_follow.txt"), rowsUpTo(10));
+	size_t rest = people.size() * sizeof(employee) - written;
+	out.write(data + written, rest).flush();
+	EXPECT_EQ(waitForReport(expected), expected);
+
+	out.close();
+	std::remove("test_follow.bin");
+	reporter.join();
+	EXPECT_EQ(reported, 1000);
+	EXPECT_EQ(readWholeFile("test_follow.txt"), expected);
+}
+
+TEST(FollowReport, FailsWhenFileIsTruncated) {
+	std::vector<employee> people;
+	for (int i = 0; i < 10; i++) {
+		people.push_back(makeEmployee(i, "Trunc", i));
+	}
+	writeLegacyFile("test_follow_trunc.bin", people);
+
+	ReporterOptions options;
+	options.binFileName = "test_follow_trunc.bin";
+	options.reportFileName = "test_follow_trunc.txt";
+	options.xPerHour = 2.0;
+	options.follow = true;
+	long long reported = 0;
+	std::thread reporter([&] { reported = generateReport(options); });
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	writeLegacyFile("test_follow_trunc.bin", std::vector<employee>(people.begin(), people.begin() + 3));
+	reporter.join();
+	EXPECT_EQ(reported, -1);
+	std::remove("test_follow_trunc.bin");
+}
+
+TEST(FollowReport, PollingWatcherNoticesRemovedFile) {
+	writeLegacyFile("test_follow_poll.bin", { makeEmployee(1, "Poll", 1) });
+	NativeHandle in = openForReading("test_follow_poll.bin");
+	ASSERT_NE(in, NO_HANDLE);
+	FileWatcher watcher;
+	watcher.open("test_follow_poll.bin", in);
+	// Без inotify остаётся только опрос.
+	watcher.close();
+	EXPECT_EQ(watcher.wait(), WatchEvent::TIMEOUT);
+	std::remove("test_follow_poll.bin");
+	EXPECT_EQ(watcher.wait(), WatchEvent::GONE);
+	closeHandle(in);
+}
+#endif
+
+TEST(ParallelCreator, OutputDoesNotDependOnThreadCount) {
+	CreatorOptions options;
+	options.fileName = "test_parallel_1.bin";
+	options.count = 3 * CHECKSUM_BLOCK_RECORDS + 123;
+	options.source = CreatorSource::SYNTHETIC;
+	options.seed = 42;
+	options.checksum = true;
+	ASSERT_EQ(createEmployees(options), 0);
+	std::string expected = readWholeFile("test_parallel_1.bin");
+	std::string expectedSums = readWholeFile("test_parallel_1.bin.crc");
+	ASSERT_EQ(expected.size(), options.count * sizeof(employee));
+
+	for (size_t threads : { 2, 3, 8 }) {
+		options.fileName = "test_parallel_" + std::to_string(threads) + ".bin";
+		options.threads = threads;
+		ASSERT_EQ(createEmployees(options), 0);
+		EXPECT_EQ(readWholeFile(options.fileName), expected);
+		EXPECT_EQ(readWholeFile(options.fileName + ".crc"), expectedSums);
+	}
+
+	options.count = 0;
+	ASSERT_EQ(createEmployees(options), 0);
+	EXPECT_EQ(readWholeFile(options.fileName), "");
+}
+
+TEST(IncrementalReport, VerifiesBlockStraddlingCheckpoint) {
+	CreatorOptions creator;
+	creator.fileName = "test_crc_incremental.bin";
+	creator.count = CHECKSUM_BLOCK_RECORDS + 100;
+	creator.source = CreatorSource::SYNTHETIC;
+	creator.seed = 3;
+	creator.checksum = true;
+	ASSERT_EQ(createEmployees(creator), 0);
+
+	ReporterOptions options;
+	options.binFileName = creator.fileName;
+	options.reportFileName = "test_crc_incremental.txt";
+	options.xPerHour = 1.0;
+	options.incremental = true;
+	std::remove("test_crc_incremental.txt.ckpt");
+	ASSERT_EQ(generateReport(options), static_cast<long long>(creator.count));
+
+	// Дописанные записи попадают в блок, начатый до контрольной точки.
+	creator.count += 100;
+	ASSERT_EQ(createEmployees(creator), 0);
+	{
+		std::fstream file(creator.fileName, std::ios::binary | std::ios::in | std::ios::out);
+		file.seekp((CHECKSUM_BLOCK_RECORDS + 150) * sizeof(employee) + offsetof(employee, hours));
+		file.put('\x7f');
+	}
+	EXPECT_EQ(generateReport(options), -1);
+}
@@ -4,6 +4,7 @@
 #include <iostream>
 #include <climits>
 #include <cfloat>
+#include "../../Common/record_schema.h"
 
 const std::string PIPE_NAME = "\\\\.\\pipe\\EmployeePipe";
 const int NAME_SIZE = 30;
@@ -15,6 +16,12 @@ struct Employee {
 	double hours;
 };
 
+// Columns of the server's file listing.
+using EmployeeSchema = RecordSchema<Employee,
+	Field<&Employee::num, 10>,
+	Field<&Employee::name, 35>,
+	Field<&Employee::hours, 10>>;
+
 enum class RequestType {
 	READ,
 	MODIFY
@@ -30,9 +30,11 @@ void printFileContent(const std::string& filename) {
 	std::cout << std::left << std::setw(10) << "ID" << std::setw(35) << "Name" << std::setw(10) << "Hours" << "\n";
 	std::cout << std::string(55, '-') << "\n";
 
+	char row[EmployeeSchema::maxFormattedSize + 1];
 	while (ReadFile(hFile, &e, sizeof(Employee), &bytesRead, NULL) && bytesRead > 0) {
-		std::cout << std::left << std::setw(10) << e.num
-			<< std::setw(35) << e.name << std::setw(10) << e.hours << "\n";
+		char* end = EmployeeSchema::format(e, row);
+		*end++ = '\n';
+		std::cout.write(row, end - row);
 	}
 	std::cout << std::string(55, '-') << "\n";
 	LeaveCriticalSection(&g_csConsole);